@@ -0,0 +1,414 @@
+/*
+Documentation
+Name        : Vamsi T
+Date        : 30/7/25
+Description : MP3 Tag Reader project - cover art (APIC) extract and replace
+*/
+
+#define _GNU_SOURCE
+#include "mp3_tag_reader.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define EXTRACT_MAX_SUFFIX 1000 // <name>-1 ... <name>-999 when files from different directories share a name
+
+// Frame format flags that change how the frame data is stored
+static int frame_data_is_raw(const unsigned char *header, unsigned char version)
+{
+    if (version >= 4)
+        return (header[9] & 0x4F) == 0; // Grouping, compression, encryption, unsynchronisation, data length
+    return (header[9] & 0xE0) == 0;     // Compression, encryption, grouping
+}
+
+// Reads the APIC fields in front of the picture data, returns the number of bytes they take
+long read_apic_prefix(FILE *fp, unsigned int size, char mime[], int *picture_type)
+{
+    long used = 0;
+    int ch;
+
+    int encoding = fgetc(fp);
+    if (encoding == EOF)
+        return -1;
+    used++;
+
+    // MIME type, always ISO-8859-1
+    int len = 0;
+    while ((ch = fgetc(fp)) != EOF && ch != 0)
+    {
+        if (len < MAX_MIME_LEN - 1)
+            mime[len++] = ch;
+        used++;
+    }
+    mime[len] = '\0';
+    if (ch == EOF)
+        return -1;
+    used++;
+
+    // Picture type, 3 is the front cover
+    if ((*picture_type = fgetc(fp)) == EOF)
+        return -1;
+    used++;
+
+    // Description, terminated by 00 or 00 00 for UTF-16
+    if (encoding == 1 || encoding == 2)
+    {
+        int lo, hi;
+        do
+        {
+            lo = fgetc(fp);
+            hi = fgetc(fp);
+            used += 2;
+        } while (lo != EOF && hi != EOF && (lo != 0 || hi != 0) && used < (long)size);
+        if (lo == EOF || hi == EOF)
+            return -1;
+    }
+    else
+    {
+        do
+        {
+            ch = fgetc(fp);
+            used++;
+        } while (ch != EOF && ch != 0 && used < (long)size);
+        if (ch == EOF)
+            return -1;
+    }
+
+    return used > (long)size ? -1 : used;
+}
+
+// The front cover (picture type 3), the picture replace_art_file replaces, or the first picture when there is none
+static Status find_cover(TagOperationInfo *tagopinfo, off_t *frame_offset, unsigned int *size)
+{
+    FILE *fp = tagopinfo->fptr_mp3;
+    off_t tag_end = 10 + (off_t)tagopinfo->tag_size;
+    int found = 0;
+
+    // 10-byte frame headers only, like find_frame
+    if (tagopinfo->version < 3)
+        return failure;
+
+    for (off_t offset = 10; offset + 10 <= tag_end;)
+    {
+        unsigned char header[10];
+        if (fseeko(fp, offset, SEEK_SET) != 0 || fread(header, 10, 1, fp) != 1 || header[0] < 'A' || header[0] > 'Z')
+            break;
+
+        unsigned int frame_size = decode_frame_size(&header[4], tagopinfo->version);
+        if (check_frame_fits(offset + 10, frame_size, tag_end) != success)
+            break;
+
+        if (memcmp(header, "APIC", 4) == 0)
+        {
+            char mime[MAX_MIME_LEN];
+            int picture_type;
+            int front = frame_data_is_raw(header, tagopinfo->version) &&
+                        read_apic_prefix(fp, frame_size, mime, &picture_type) >= 0 && picture_type == 3;
+            if (!found || front)
+            {
+                *frame_offset = offset;
+                *size = frame_size;
+                found = 1;
+            }
+            if (front)
+                break;
+        }
+        offset += 10 + (off_t)frame_size;
+    }
+
+    return found ? success : failure;
+}
+
+static const char *image_extension(const char *mime)
+{
+    if (strcmp(mime, "image/jpeg") == 0 || strcmp(mime, "image/jpg") == 0 || strcmp(mime, "JPG") == 0)
+        return "jpg";
+    if (strcmp(mime, "image/png") == 0 || strcmp(mime, "PNG") == 0)
+        return "png";
+    if (strcmp(mime, "image/gif") == 0)
+        return "gif";
+    return "bin";
+}
+
+static Status send_range(int src_fd, off_t offset, int dst_fd, off_t length)
+{
+    off_t pos = offset;
+
+    // Stream straight from the tag offset, the image never passes through user space
+    while (length > 0)
+    {
+        ssize_t n = sendfile(dst_fd, src_fd, &pos, length);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EINVAL || errno == ENOSYS)
+                return copy_fd_range(src_fd, pos, dst_fd, lseek(dst_fd, 0, SEEK_CUR), length);
+            perror("❌ sendfile failed");
+            return failure;
+        }
+        if (n == 0)
+        {
+            fprintf(stderr, "❌ Error: Unexpected end of file while copying picture.\n");
+            return failure;
+        }
+        length -= n;
+    }
+
+    return success;
+}
+
+Status extract_art_file(const char *out_dir, char *filename)
+{
+    if (!is_mp3_filename(filename))
+    {
+        fprintf(stderr, "❌ Error: '%s' is not a .mp3 file\n", filename);
+        return failure;
+    }
+
+    TagOperationInfo tagopinfo = {0};
+    tagopinfo.filename = filename;
+
+    if (open_mp3_file_view(&tagopinfo) != success)
+        return failure;
+
+    if (check_id_and_version(&tagopinfo) != success)
+    {
+        close_files(&tagopinfo);
+        return failure;
+    }
+
+    off_t frame_offset;
+    unsigned int size;
+    if (find_cover(&tagopinfo, &frame_offset, &size) != success)
+    {
+        fprintf(stderr, "❌ Error: No cover art (APIC) found in '%s'\n", filename);
+        close_files(&tagopinfo);
+        return failure;
+    }
+
+    unsigned char header[10];
+    fseeko(tagopinfo.fptr_mp3, frame_offset, SEEK_SET);
+    if (fread(header, 10, 1, tagopinfo.fptr_mp3) != 1 || !frame_data_is_raw(header, tagopinfo.version) ||
+        (tagopinfo.flags & 0x80))
+    {
+        fprintf(stderr, "❌ Error: Cover art in '%s' is compressed, encrypted or unsynchronised\n", filename);
+        close_files(&tagopinfo);
+        return failure;
+    }
+
+    char mime[MAX_MIME_LEN];
+    int picture_type;
+    long prefix = read_apic_prefix(tagopinfo.fptr_mp3, size, mime, &picture_type);
+    if (prefix < 0)
+    {
+        fprintf(stderr, "❌ Error: Malformed APIC frame in '%s'\n", filename);
+        close_files(&tagopinfo);
+        return failure;
+    }
+
+    // <out_dir>/<mp3 name without extension>.<image extension>, an existing image is never overwritten:
+    // a/01.mp3 and b/01.mp3 give 01.png and 01-1.png
+    const char *base = strrchr(filename, '/');
+    base = base ? base + 1 : filename;
+    char out_path[4096];
+    int out_fd = -1;
+    for (int n = 0; out_fd < 0 && n < EXTRACT_MAX_SUFFIX; n++)
+    {
+        char suffix[16] = "";
+        if (n > 0)
+            snprintf(suffix, sizeof(suffix), "-%d", n);
+        if (snprintf(out_path, sizeof(out_path), "%s/%.*s%s.%s", out_dir, (int)strlen(base) - 4, base, suffix,
+                     image_extension(mime)) >= (int)sizeof(out_path))
+        {
+            fprintf(stderr, "❌ Error: Output path for '%s' is too long\n", filename);
+            close_files(&tagopinfo);
+            return failure;
+        }
+
+        out_fd = open(out_path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+        if (out_fd < 0 && errno != EEXIST)
+            break;
+    }
+    if (out_fd < 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to create '%s': %s\n", out_path, strerror(errno));
+        close_files(&tagopinfo);
+        return failure;
+    }
+
+    off_t data_offset = frame_offset + 10 + prefix;
+    off_t data_size = (off_t)size - prefix;
+    Status status = send_range(fileno(tagopinfo.fptr_mp3), data_offset, out_fd, data_size);
+
+    if (close(out_fd) != 0)
+        status = failure;
+    close_files(&tagopinfo);
+
+    if (status != success)
+    {
+        remove(out_path);
+        return failure;
+    }
+
+    printf("🖼️  Extracted %lld bytes (%s) to %s\n", (long long)data_size, mime, out_path);
+    return success;
+}
+
+Status replace_art_file(const char *image, char *filename)
+{
+    if (!is_mp3_filename(filename))
+    {
+        fprintf(stderr, "❌ Error: '%s' is not a .mp3 file\n", filename);
+        return failure;
+    }
+
+    int image_fd = open(image, O_RDONLY);
+    if (image_fd < 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to open image '%s': %s\n", image, strerror(errno));
+        return failure;
+    }
+
+    // Pick the MIME type from the image signature
+    unsigned char magic[8] = {0};
+    struct stat st;
+    const char *mime = NULL;
+    if (pread(image_fd, magic, sizeof(magic), 0) >= 3 && fstat(image_fd, &st) == 0)
+    {
+        if (magic[0] == 0xFF && magic[1] == 0xD8)
+            mime = "image/jpeg";
+        else if (memcmp(magic, "\x89PNG", 4) == 0)
+            mime = "image/png";
+        else if (memcmp(magic, "GIF", 3) == 0)
+            mime = "image/gif";
+    }
+    if (mime == NULL)
+    {
+        fprintf(stderr, "❌ Error: '%s' is not a JPEG, PNG or GIF image\n", image);
+        close(image_fd);
+        return failure;
+    }
+
+    TagOperationInfo tagopinfo = {0};
+    tagopinfo.filename = filename;
+
+    Status status = failure;
+    if (open_mp3_file_edit(&tagopinfo) != success || check_id_and_version(&tagopinfo) != success)
+        goto out;
+
+    // Frame headers are 6 bytes in v2.2 and pictures are PIC frames, copy_frames writes 10-byte headers
+    if (tagopinfo.version < 3)
+    {
+        fprintf(stderr, "❌ Error: Replacing art in ID3v2.%d tags is not supported\n", tagopinfo.version);
+        goto out;
+    }
+    if (tagopinfo.flags & 0x80)
+    {
+        fprintf(stderr, "❌ Error: Unsynchronised tags are not supported\n");
+        goto out;
+    }
+
+    // APIC: encoding, MIME, NUL, picture type (front cover), empty description, picture data
+    unsigned char apic_header[10];
+    unsigned char prefix[MAX_MIME_LEN + 4];
+    long prefix_len = 0;
+    prefix[prefix_len++] = 0;
+    memcpy(&prefix[prefix_len], mime, strlen(mime) + 1);
+    prefix_len += strlen(mime) + 1;
+    prefix[prefix_len++] = 3;
+    prefix[prefix_len++] = 0;
+
+    off_t frame_size = prefix_len + st.st_size;
+    if (frame_size > (tagopinfo.version >= 4 ? 0x0FFFFFFF : 0x7FFFFFFF))
+    {
+        fprintf(stderr, "❌ Error: Image '%s' is too large for an APIC frame\n", image);
+        goto out;
+    }
+    memcpy(apic_header, "APIC", 4);
+    encode_frame_size(frame_size, tagopinfo.version, &apic_header[4]);
+    apic_header[8] = 0;
+    apic_header[9] = 0;
+
+    // Copy the ID3v2 header, then every frame except the old front cover, other pictures are kept
+    if (copy_id3_header(&tagopinfo) != success || copy_frames(&tagopinfo, "APIC", 3) != success)
+        goto out;
+
+    if (fwrite(apic_header, 10, 1, tagopinfo.fptr_new_mp3) != 1 ||
+        fwrite(prefix, prefix_len, 1, tagopinfo.fptr_new_mp3) != 1 || fflush(tagopinfo.fptr_new_mp3) != 0)
+    {
+        fprintf(stderr, "❌ Error writing APIC frame.\n");
+        goto out;
+    }
+
+    if (copy_fd_range(image_fd, 0, fileno(tagopinfo.fptr_new_mp3), ftello(tagopinfo.fptr_new_mp3), st.st_size) != success)
+        goto out;
+    fseeko(tagopinfo.fptr_new_mp3, 0, SEEK_END);
+
+    if (copy_padding_and_audio(&tagopinfo) != success)
+        goto out;
+
+    close(image_fd);
+    close_files(&tagopinfo);
+    if (rename_mp3_file(&tagopinfo) != success)
+        return failure;
+
+    printf("🖼️  Replaced cover art in %s with %s (%lld bytes)\n", filename, image, (long long)st.st_size);
+    return success;
+
+out:
+    // The original is untouched, drop the partial copy
+    close(image_fd);
+    close_files(&tagopinfo);
+    if (tagopinfo.new_filename != NULL)
+        remove(tagopinfo.new_filename);
+    return status;
+}
+
+// Runs one cover art operation over a batch, skipping files the journal says are done
+static Status run_art_batch(Status (*operation)(const char *, char *), const char *arg, int count, char *files[],
+                            const char *journal_path, const char *verb)
+{
+    BatchJournal journal;
+    if (batch_journal_open(&journal, journal_path, count) != success)
+        return failure;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (batch_is_done(&journal, files[i]))
+            continue;
+
+        if (operation(arg, files[i]) == success)
+            batch_mark_done(&journal, files[i]);
+        else
+            batch_mark_failed(&journal);
+    }
+
+    int done = journal.done, skipped = journal.skipped, failed = journal.failed;
+    batch_journal_close(&journal);
+
+    printf("\n🖼️  Cover art %s %d of %d file(s)", verb, done, count);
+    if (skipped)
+        printf(", %d already done", skipped);
+    printf("\n");
+    return failed ? failure : success;
+}
+
+Status extract_art(const char *out_dir, int count, char *files[], const char *journal_path)
+{
+    struct stat st;
+    if (stat(out_dir, &st) != 0 || !S_ISDIR(st.st_mode))
+    {
+        fprintf(stderr, "❌ Error: '%s' is not a directory\n", out_dir);
+        return failure;
+    }
+
+    return run_art_batch(extract_art_file, out_dir, count, files, journal_path, "extracted from");
+}
+
+Status replace_art(const char *image, int count, char *files[], const char *journal_path)
+{
+    return run_art_batch(replace_art_file, image, count, files, journal_path, "replaced in");
+}
@@ -8,36 +8,19 @@ Description : MP3 Tag Reader project
 
 #include "mp3_tag_reader.h"
 #include <stdio.h>
+#include <sys/stat.h>
 
 Status read_and_validate_edit_args(char *argv[], TagOperationInfo *tagopinfo)
 {
     printf("🔍 Validating Arguments...\n");
 
-    if (strcmp(argv[2], "-t") == 0)
-    {
-        tagopinfo->tag_index = 0;
-    }
-    else if (strcmp(argv[2], "-a") == 0)
-    {
-        tagopinfo->tag_index = 1;
-    }
-    else if (strcmp(argv[2], "-A") == 0)
-    {
-        tagopinfo->tag_index = 2;
-    }
-    else if (strcmp(argv[2], "-y") == 0)
-    {
-        tagopinfo->tag_index = 3;
-    }
-    else if (strcmp(argv[2], "-m") == 0)
-    {
-        tagopinfo->tag_index = 4;
-    }
-    else if (strcmp(argv[2], "-c") == 0)
-    {
-        tagopinfo->tag_index = 5;
-    }
+    // -t / -a / -A / -y / -m / -c are looked up in the frame registry
+    if (argv[2][0] == '-' && strlen(argv[2]) == 2)
+        tagopinfo->frame = lookup_edit_option(argv[2][1], 0);
     else
+        tagopinfo->frame = NULL;
+
+    if (tagopinfo->frame == NULL)
     {
         fprintf(stderr, "\n❌ Invalid tag option: '%s'\n", argv[2]);
         return failure;
@@ -53,30 +36,19 @@ Status read_and_validate_edit_args(char *argv[], TagOperationInfo *tagopinfo)
             return failure;
         }
 
-        switch (tagopinfo->tag_index) // 0
+        if (strlen(argv[3]) >= sizeof(tagopinfo->new_value))
         {
-        case 0:
-        case 1:
-        case 2:
-        case 4:
-        case 5:
-            strcpy(tagopinfo->new_value, argv[3]);
-            break;
-
-        case 3:
-            // Year should be 4 digits
-            if (strlen(argv[3]) != 4 || strspn(argv[3], "0123456789") != 4)
-            {
-                fprintf(stderr, "❌ Error: Year must be a 4-digit number (ex-> 2025)\n");
-                return failure;
-            }
-            strcpy(tagopinfo->new_value, argv[3]);
-            break;
+            fprintf(stderr, "❌ Error: New value for tag must be shorter than %zu characters\n", sizeof(tagopinfo->new_value));
+            return failure;
+        }
 
-        default:
-            fprintf(stderr, "❌ Unknown tag type. Cannot apply change\n");
+        // Year should be 4 digits
+        if (tagopinfo->frame->field == FIELD_YEAR && (strlen(argv[3]) != 4 || strspn(argv[3], "0123456789") != 4))
+        {
+            fprintf(stderr, "❌ Error: Year must be a 4-digit number (ex-> 2025)\n");
             return failure;
         }
+        strcpy(tagopinfo->new_value, argv[3]);
     }
     else
     {
@@ -91,10 +63,7 @@ Status read_and_validate_edit_args(char *argv[], TagOperationInfo *tagopinfo)
         return failure;
     }
     // Validate .mp3 extension (basic check)
-    const char *filename = argv[4];
-    int len = strlen(filename);
-
-    if (len < 5 || strcmp(&filename[len - 4], ".mp3") != 0)
+    if (!is_mp3_filename(argv[4]))
     {
         fprintf(stderr, "❌ Error: Invalid file format. Please provide a valid .mp3 file\n");
         return failure;
@@ -124,13 +93,38 @@ Status edit(TagOperationInfo *tagopinfo)
     if (check_id_and_version(tagopinfo) != success)
     {
         fprintf(stderr, "❌ Failed to detect ID3 tag/version\n");
+        close_files(tagopinfo);
+        remove(tagopinfo->new_filename);
         return failure;
     }
     printf("✅ Done\n\n");
 
+    // Frame headers are 6 bytes in v2.2, the edit path writes 10-byte headers
+    if (tagopinfo->version < 3)
+    {
+        fprintf(stderr, "❌ Editing ID3v2.%d tags is not supported\n", tagopinfo->version);
+        close_files(tagopinfo);
+        remove(tagopinfo->new_filename);
+        return failure;
+    }
+
+    // The option names a frame of this tag's version (-y is TYER in v2.3 and TDRC in v2.4)
+    const FrameInfo *frame = lookup_edit_option(tagopinfo->frame->option, tagopinfo->version);
+    if (frame == NULL)
+    {
+        fprintf(stderr, "❌ Option -%c has no frame in ID3v2.%d\n", tagopinfo->frame->option, tagopinfo->version);
+        close_files(tagopinfo);
+        remove(tagopinfo->new_filename);
+        return failure;
+    }
+    tagopinfo->frame = frame;
+
     if (edit_mp3_tag(tagopinfo) != success)
     {
+        // The original is still in place, drop the half-written copy
         fprintf(stderr, "❌ Failed to edit MP3 tags\n");
+        close_files(tagopinfo);
+        remove(tagopinfo->new_filename);
         return failure;
     }
     printf("✅ Done\n\n");
@@ -152,6 +146,13 @@ Status edit(TagOperationInfo *tagopinfo)
     }
     printf("✅ Done\n\n");
 
+    // The tag may have grown, read the new header
+    if (check_id_and_version(tagopinfo) != success)
+    {
+        fprintf(stderr, "❌ Failed to detect ID3 tag/version\n");
+        return failure;
+    }
+
     if (view_mp3_tags(tagopinfo) != success)
     {
         fprintf(stderr, "❌ Failed to view MP3 tags.\n");
@@ -191,26 +192,86 @@ Status edit_mp3_tag(TagOperationInfo *tagopinfo)
     return success;
 }
 
-Status copy_first_part(TagOperationInfo *tagopinfo)
+/* Frames that fit in one buffer go through stdio; flushing and seeking per frame
+   costs a few syscalls each, which dominates tags made of many tiny frames. */
+#define FRAME_COPY_INLINE 4096
+
+static Status copy_frame_body(FILE *src, FILE *dst, unsigned int size)
 {
-    printf("\n📁 Copying first part of the MP3 file...\n");
-    rewind(tagopinfo->fptr_mp3); // Start of original MP3 file
+    if (size <= FRAME_COPY_INLINE)
+    {
+        unsigned char buffer[FRAME_COPY_INLINE];
+        if (size > 0 && (fread(buffer, size, 1, src) != 1 || fwrite(buffer, size, 1, dst) != 1))
+            return failure;
+        return success;
+    }
 
-    // Copy ID3v2 header (10 bytes)
-    char ch;
-    for (int i = 0; i < 10; i++)
+    off_t src_offset = ftello(src);
+    if (fflush(dst) != 0 || copy_fd_range(fileno(src), src_offset, fileno(dst), ftello(dst), size) != success)
+        return failure;
+    fseeko(src, src_offset + size, SEEK_SET);
+    fseeko(dst, 0, SEEK_END);
+    return success;
+}
+
+Status copy_id3_header(TagOperationInfo *tagopinfo)
+{
+    FILE *src = tagopinfo->fptr_mp3;
+    unsigned char header[10];
+    rewind(src); // Start of original MP3 file
+    if (fread(header, 10, 1, src) != 1)
     {
-        if (fread(&ch, 1, 1, tagopinfo->fptr_mp3) != 1 ||
-            fwrite(&ch, 1, 1, tagopinfo->fptr_new_mp3) != 1)
+        fprintf(stderr, "❌ Error reading ID3 header.\n");
+        return failure;
+    }
+
+    // A truncated file would otherwise get the whole claimed tag size written as padding
+    struct stat st;
+    if (fstat(fileno(src), &st) != 0 || 10 + (off_t)tagopinfo->tag_size > st.st_size)
+    {
+        fprintf(stderr, "❌ Error: ID3 tag runs past the end of the file.\n");
+        return failure;
+    }
+
+    // The extended header (CRC, restrictions) describes the old tag, drop it rather than copy it stale
+    if (header[5] & 0x40)
+    {
+        unsigned char size_bytes[4];
+        if (fread(size_bytes, 4, 1, src) != 1)
         {
-            fprintf(stderr, "❌ Error reading/writing ID3 header byte.\n");
+            fprintf(stderr, "❌ Error reading extended header.\n");
             return failure;
         }
+
+        // v2.4 counts the size bytes in the size, v2.3 does not
+        off_t ext = (tagopinfo->version >= 4) ? (off_t)convert_big_endian_to_little_endian(size_bytes)
+                                              : 4 + (off_t)decode_frame_size(size_bytes, 3);
+        if (ext < 4 || ext > (off_t)tagopinfo->tag_size || fseeko(src, 10 + ext, SEEK_SET) != 0)
+        {
+            fprintf(stderr, "❌ Error: Extended header runs past the end of the ID3 tag.\n");
+            return failure;
+        }
+        header[5] &= ~0x40;
     }
 
-    // printf("🔢 tag_index: %d\n", tagopinfo->tag_index);
+    if (fwrite(header, 10, 1, tagopinfo->fptr_new_mp3) != 1)
+    {
+        fprintf(stderr, "❌ Error writing ID3 header.\n");
+        return failure;
+    }
+    return success;
+}
+
+Status copy_first_part(TagOperationInfo *tagopinfo)
+{
+    printf("\n📁 Copying first part of the MP3 file...\n");
 
-    for (int i = 0; i < tagopinfo->tag_index; i++)
+    // Copy ID3v2 header (10 bytes)
+    if (copy_id3_header(tagopinfo) != success)
+        return failure;
+
+    // Copy every frame in front of the one being edited
+    while (ftello(tagopinfo->fptr_mp3) + 10 <= 10 + (off_t)tagopinfo->tag_size)
     {
         char tag[5] = {0};
         if (fread(tag, 4, 1, tagopinfo->fptr_mp3) != 1)
@@ -225,7 +286,15 @@ Status copy_first_part(TagOperationInfo *tagopinfo)
         // Check for padding or non-frame identifier
         if (tag[0] < 'A' || tag[0] > 'Z')
         {
-            printf("🛑 Padding or invalid tag encountered. Stopping tag copy.\n");
+            printf("🛑 Padding reached, %s will be added as a new frame.\n", tagopinfo->frame->id);
+            fseeko(tagopinfo->fptr_mp3, -4, SEEK_CUR);
+            break;
+        }
+
+        // modify_tag takes over at the frame being edited
+        if (strcmp(tag, tagopinfo->frame->id) == 0)
+        {
+            fseeko(tagopinfo->fptr_mp3, -4, SEEK_CUR);
             break;
         }
 
@@ -237,7 +306,7 @@ Status copy_first_part(TagOperationInfo *tagopinfo)
             return failure;
         }
 
-        unsigned int size = convert_big_endian_to_little_endian(size_bytes);
+        unsigned int size = decode_frame_size(size_bytes, tagopinfo->version);
         // printf("📏 Tag size bytes: %02X %02X %02X %02X\n", size_bytes[0], size_bytes[1], size_bytes[2], size_bytes[3]);
         // printf("📦 Decoded size: %u bytes\n", size);
 
@@ -249,34 +318,24 @@ Status copy_first_part(TagOperationInfo *tagopinfo)
             return failure;
         }
 
-        // Write tag, size and flags
-        fwrite(tag, 4, 1, tagopinfo->fptr_new_mp3);
-        fwrite(size_bytes, 4, 1, tagopinfo->fptr_new_mp3);
-        fwrite(flags, 2, 1, tagopinfo->fptr_new_mp3);
-
-        // Allocate and copy content
-        char *cont = malloc(size);
-        if (!cont)
+        off_t src_offset = ftello(tagopinfo->fptr_mp3);
+        if (check_frame_fits(src_offset, size, 10 + (off_t)tagopinfo->tag_size) != success)
         {
-            fprintf(stderr, "❌ Memory allocation failed.\n");
+            fprintf(stderr, "❌ Error: Size of tag %s runs past the end of the ID3 tag.\n", tag);
             return failure;
         }
 
-        if (fread(cont, size, 1, tagopinfo->fptr_mp3) != 1)
-        {
-            fprintf(stderr, "❌ Error reading content for tag: %s\n", tag);
-            free(cont);
-            return failure;
-        }
+        // Write tag, size and flags
+        fwrite(tag, 4, 1, tagopinfo->fptr_new_mp3);
+        fwrite(size_bytes, 4, 1, tagopinfo->fptr_new_mp3);
+        fwrite(flags, 2, 1, tagopinfo->fptr_new_mp3);
 
-        if (fwrite(cont, size, 1, tagopinfo->fptr_new_mp3) != 1)
+        // Copy content, large frames with pread/pwrite at 64-bit offsets
+        if (copy_frame_body(tagopinfo->fptr_mp3, tagopinfo->fptr_new_mp3, size) != success)
         {
-            fprintf(stderr, "❌ Error writing content for tag: %s\n", tag);
-            free(cont);
+            fprintf(stderr, "❌ Error copying content for tag: %s\n", tag);
             return failure;
         }
-
-        free(cont);
     }
 
     printf("✅ First part copied successfully.\n");
@@ -291,59 +350,91 @@ void convert_int_to_big_endian(unsigned int value, unsigned char *bytes)
     bytes[3] = value & 0xFF;
 }
 
+void convert_int_to_synchsafe(unsigned int value, unsigned char *bytes)
+{
+    // 7 bits per byte, the high bit is always clear
+    bytes[0] = (value >> 21) & 0x7F;
+    bytes[1] = (value >> 14) & 0x7F;
+    bytes[2] = (value >> 7) & 0x7F;
+    bytes[3] = value & 0x7F;
+}
+
+void encode_frame_size(unsigned int value, unsigned char version, unsigned char *bytes)
+{
+    // ID3v2.4 frame sizes are synchsafe, ID3v2.3 frame sizes are plain 32-bit big endian
+    if (version >= 4)
+        convert_int_to_synchsafe(value, bytes);
+    else
+        convert_int_to_big_endian(value, bytes);
+}
+
+off_t id3_audio_offset(unsigned char version, unsigned char flags, unsigned int tag_size)
+{
+    // A v2.4 footer repeats the header after the padding, the audio starts behind it
+    return 10 + (off_t)tag_size + ((version >= 4 && (flags & 0x10)) ? 10 : 0);
+}
+
 Status modify_tag(TagOperationInfo *tagopinfo)
 {
     printf("📁 Modifying tag...\n");
 
     printf("📝 Overwriting tag with new value: %s\n", tagopinfo->new_value);
 
-    char tag[5] = {0};
-    if (fread(tag, 4, 1, tagopinfo->fptr_mp3) != 1)
+    const FrameInfo *frame = tagopinfo->frame;
+    unsigned char header[10] = {0};
+    off_t tag_end = 10 + (off_t)tagopinfo->tag_size;
+
+    // Replace the existing frame, or add one when copy_first_part stopped at the padding
+    off_t offset = ftello(tagopinfo->fptr_mp3);
+    if (offset + 10 <= tag_end && fread(header, 10, 1, tagopinfo->fptr_mp3) == 1 && strncmp((char *)header, frame->id, 4) == 0)
     {
-        fprintf(stderr, "❌ Error reading tag identifier.\n");
-        return failure;
-    }
-    tag[4] = '\0';
-    // printf("🏷️  Tag: %s\n", tag);
+        unsigned int original_size = decode_frame_size(&header[4], tagopinfo->version);
+        // printf("📦 Original tag size: %u bytes\n", original_size);
 
-    unsigned char size_bytes[4];
-    if (fread(size_bytes, 4, 1, tagopinfo->fptr_mp3) != 1)
+        if (check_frame_fits(ftello(tagopinfo->fptr_mp3), original_size, tag_end) != success)
+        {
+            fprintf(stderr, "❌ Error: Invalid size %u for tag: %s\n", original_size, frame->id);
+            return failure;
+        }
+
+        // Skip the original tag content in the input MP3
+        if (fseeko(tagopinfo->fptr_mp3, original_size, SEEK_CUR) != 0)
+        {
+            fprintf(stderr, "❌ Failed to skip old tag content.\n");
+            return failure;
+        }
+    }
+    else
     {
-        fprintf(stderr, "❌ Error reading size for tag: %s\n", tag);
-        return failure;
+        fseeko(tagopinfo->fptr_mp3, offset, SEEK_SET);
+        memset(header, 0, sizeof(header));
+        memcpy(header, frame->id, 4);
     }
 
-    unsigned int original_size = convert_big_endian_to_little_endian(size_bytes);
-    // printf("📏 Tag size bytes: %02X %02X %02X %02X\n", size_bytes[0], size_bytes[1], size_bytes[2], size_bytes[3]);
-    // printf("📦 Original tag size: %u bytes\n", original_size);
-
-    unsigned char flags[3];
-    if (fread(flags, 3, 1, tagopinfo->fptr_mp3) != 1)
+    // Prepare new tag value with the frame's encoder (encoding byte included)
+    unsigned char content[4 * sizeof(tagopinfo->new_value) + 16];
+    FrameEncoder encode = frame_encoder(frame);
+    unsigned int new_size = encode ? encode(tagopinfo->new_value, tagopinfo->version, content, sizeof(content)) : 0;
+    if (new_size == 0)
     {
-        fprintf(stderr, "❌ Error reading flags for tag: %s\n", tag);
+        fprintf(stderr, "❌ Error: Unable to encode new value for tag: %s\n", frame->id);
         return failure;
     }
-
-    // Prepare new tag value
-    unsigned int new_size = strlen(tagopinfo->new_value);
     // printf("📦 new size: %u bytes\n", new_size);
-    convert_int_to_big_endian(new_size + 1, size_bytes); // reuse same array to write new size
-
-    // Write updated tag to new file
-    fwrite(tag, 4, 1, tagopinfo->fptr_new_mp3);
-    fwrite(size_bytes, 4, 1, tagopinfo->fptr_new_mp3);
-    fwrite(flags, 3, 1, tagopinfo->fptr_new_mp3);
-    fwrite(tagopinfo->new_value, new_size, 1, tagopinfo->fptr_new_mp3);
+    encode_frame_size(new_size, tagopinfo->version, &header[4]);
 
-    printf("✅ Tag overwritten successfully\n");
+    // Keep the status flags, the new content is never compressed or encrypted
+    header[9] = 0;
 
-    // Skip the original tag content in the input MP3
-    if (fseek(tagopinfo->fptr_mp3, original_size - 1, SEEK_CUR) != 0)
+    // Write updated tag to new file
+    if (fwrite(header, 10, 1, tagopinfo->fptr_new_mp3) != 1 ||
+        fwrite(content, new_size, 1, tagopinfo->fptr_new_mp3) != 1)
     {
-        fprintf(stderr, "❌ Failed to skip old tag content.\n");
+        fprintf(stderr, "❌ Error writing tag: %s\n", frame->id);
         return failure;
     }
 
+    printf("✅ Tag overwritten successfully\n");
     return success;
 }
 
@@ -351,23 +442,187 @@ Status copy_remaining(TagOperationInfo *tagopinfo)
 {
     printf("📤 Copying remaining part of the MP3 file...\n");
 
-    char ch;
-    while (fread(&ch, 1, 1, tagopinfo->fptr_mp3) == 1)
+    // Copy the frames that follow the edited one, stopping at the padding
+    if (copy_frames(tagopinfo, NULL, -1) != success)
+        return failure;
+
+    if (copy_padding_and_audio(tagopinfo) != success)
+        return failure;
+
+    printf("✅ Remaining part copied successfully\n");
+    return success;
+}
+
+Status copy_frames(TagOperationInfo *tagopinfo, const char *skip_id, int skip_picture_type)
+{
+    FILE *src = tagopinfo->fptr_mp3;
+    FILE *dst = tagopinfo->fptr_new_mp3;
+    off_t audio_offset = 10 + (off_t)tagopinfo->tag_size;
+
+    while (ftello(src) + 10 <= audio_offset)
     {
-        if (fwrite(&ch, 1, 1, tagopinfo->fptr_new_mp3) != 1)
+        unsigned char header[10];
+        if (fread(header, 10, 1, src) != 1)
+        {
+            fprintf(stderr, "❌ Error reading frame header.\n");
+            return failure;
+        }
+
+        if (header[0] < 'A' || header[0] > 'Z')
+        {
+            fseeko(src, -10, SEEK_CUR); // Padding starts here
+            break;
+        }
+
+        unsigned int size = decode_frame_size(&header[4], tagopinfo->version);
+        if (check_frame_fits(ftello(src), size, audio_offset) != success)
+        {
+            fprintf(stderr, "❌ Error: Frame %.4s runs past the end of the tag.\n", header);
+            return failure;
+        }
+
+        // Drop frames that are being replaced, pictures only of the given type (format flags hide the type, keep those)
+        int skip = (skip_id != NULL && strncmp((char *)header, skip_id, 4) == 0);
+        if (skip && skip_picture_type >= 0)
+        {
+            char mime[MAX_MIME_LEN];
+            int picture_type;
+            off_t data = ftello(src);
+            skip = header[9] == 0 && read_apic_prefix(src, size, mime, &picture_type) >= 0 &&
+                   picture_type == skip_picture_type;
+            fseeko(src, data, SEEK_SET);
+        }
+        if (skip)
+        {
+            fseeko(src, size, SEEK_CUR);
+            continue;
+        }
+
+        if (fwrite(header, 10, 1, dst) != 1)
         {
             fprintf(stderr, "❌ Error writing content to new file.\n");
             return failure;
         }
+
+        if (copy_frame_body(src, dst, size) != success)
+            return failure;
+    }
+
+    return success;
+}
+
+Status copy_padding_and_audio(TagOperationInfo *tagopinfo)
+{
+    FILE *src = tagopinfo->fptr_mp3;
+    FILE *dst = tagopinfo->fptr_new_mp3;
+    off_t tag_end = 10 + (off_t)tagopinfo->tag_size;
+    off_t audio_offset = id3_audio_offset(tagopinfo->version, tagopinfo->flags, tagopinfo->tag_size);
+    off_t footer = audio_offset - tag_end;
+
+    // Anything left in the tag must be zero padding, otherwise keep it byte for byte
+    off_t frames_end = ftello(src);
+    int only_padding = 1;
+    unsigned char buffer[4096];
+    for (off_t left = tag_end - frames_end; left > 0 && only_padding;)
+    {
+        size_t want = left > (off_t)sizeof(buffer) ? sizeof(buffer) : (size_t)left;
+        if (fread(buffer, 1, want, src) != want)
+        {
+            fprintf(stderr, "❌ Error reading tag padding.\n");
+            return failure;
+        }
+        for (size_t i = 0; i < want; i++)
+        {
+            if (buffer[i] != 0)
+            {
+                only_padding = 0;
+                break;
+            }
+        }
+        left -= want;
     }
 
-    // Check for read error (fread returns 0 on EOF or error)
-    if (ferror(tagopinfo->fptr_mp3))
+    if (!only_padding)
     {
-        fprintf(stderr, "❌ Error reading from original MP3 file.\n");
+        fflush(dst);
+        if (copy_fd_range(fileno(src), frames_end, fileno(dst), ftello(dst), tag_end - frames_end) != success)
+            return failure;
+        fseeko(dst, 0, SEEK_END);
+    }
+
+    // Reuse the padding so the audio keeps its offset, or grow the tag by whole blocks
+    off_t new_frames_end = ftello(dst);
+    off_t new_tag_end = tag_end;
+    if (new_frames_end > tag_end)
+    {
+        long block = reflink_block_size(fileno(dst));
+        new_tag_end += (new_frames_end - tag_end + block - 1) / block * block;
+    }
+    off_t new_audio_offset = new_tag_end + footer;
+
+    if (new_tag_end - 10 > 0x0FFFFFFF)
+    {
+        fprintf(stderr, "❌ Error: New tag is too large for an ID3v2 header.\n");
+        return failure;
+    }
+
+    memset(buffer, 0, sizeof(buffer));
+    for (off_t left = new_tag_end - new_frames_end; left > 0;)
+    {
+        size_t want = left > (off_t)sizeof(buffer) ? sizeof(buffer) : (size_t)left;
+        if (fwrite(buffer, 1, want, dst) != want)
+        {
+            fprintf(stderr, "❌ Error writing tag padding.\n");
+            return failure;
+        }
+        left -= want;
+    }
+
+    // The footer goes behind the new padding and must repeat the new header's flags and size
+    if (footer > 0)
+    {
+        unsigned char footer_bytes[10];
+        if (fseeko(src, tag_end, SEEK_SET) != 0 || fread(footer_bytes, 10, 1, src) != 1)
+        {
+            fprintf(stderr, "❌ Error reading the ID3v2.4 footer.\n");
+            return failure;
+        }
+        footer_bytes[5] &= ~0x40; // copy_id3_header drops the extended header
+        convert_int_to_synchsafe(new_tag_end - 10, &footer_bytes[6]);
+        if (fwrite(footer_bytes, 10, 1, dst) != 1)
+        {
+            fprintf(stderr, "❌ Error copying the ID3v2.4 footer.\n");
+            return failure;
+        }
+    }
+
+    if (new_tag_end != tag_end)
+    {
+        // Update the tag size in the ID3v2 header
+        unsigned char size_bytes[4];
+        convert_int_to_synchsafe(new_tag_end - 10, size_bytes);
+        if (fseeko(dst, 6, SEEK_SET) != 0 || fwrite(size_bytes, 4, 1, dst) != 1)
+        {
+            fprintf(stderr, "❌ Error updating tag size in header.\n");
+            return failure;
+        }
+        printf("📏 Tag grown by %lld bytes\n", (long long)(new_tag_end - tag_end));
+    }
+
+    if (fflush(dst) != 0)
+    {
+        fprintf(stderr, "❌ Error writing content to new file.\n");
+        return failure;
+    }
+
+    // Share or copy the audio frames, or copy them through a checksum when verifying
+    Status copied = tagopinfo->verify ? copy_audio_verified(fileno(src), audio_offset, fileno(dst), new_audio_offset)
+                                      : copy_audio_region(fileno(src), audio_offset, fileno(dst), new_audio_offset);
+    if (copied != success)
+    {
+        fprintf(stderr, "❌ Error copying audio data to new file.\n");
         return failure;
     }
 
-    printf("✅ Remaining part copied successfully\n");
     return success;
 }
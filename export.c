@@ -0,0 +1,465 @@
+/*
+Documentation
+Name        : Vamsi T
+Date        : 30/7/25
+Description : MP3 Tag Reader project - columnar metadata export with per-thread column chunks
+*/
+
+#include "mp3_tag_reader.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Export file layout, all integers little-endian u32:
+ *
+ *   "MP3COLS1" rows columns
+ *   per column: name_len(u8) name encoding(u8)
+ *     encoding 1 (dictionary): dict_count blob_len offsets[dict_count + 1] blob codes[rows]
+ *     encoding 0 (plain)     : values[rows]
+ *
+ * Columns: title artist album year genre comment (RecordField order), path, duration_ms.
+ */
+
+#define EXPORT_STRING_COLUMNS (RECORD_FIELDS + 1) // Record fields and the path
+#define EXPORT_PATH_COLUMN RECORD_FIELDS
+#define EXPORT_MAX_THREADS 64
+#define EXPORT_SPARE_FDS 16 // stdio, the output file and whatever the C library holds
+
+static const char *const export_column_names[EXPORT_STRING_COLUMNS + 1] = {
+    "title", "artist", "album", "year", "genre", "comment", "path", "duration_ms"};
+
+// Distinct strings of one column, code = index into offsets
+typedef struct
+{
+    char *data;
+    size_t data_len;
+    size_t data_cap;
+    unsigned int *offsets; // count + 1 entries
+    unsigned int count;
+    unsigned int cap;
+    unsigned int *slots; // Open addressing, code + 1, 0 when empty
+    unsigned int slot_cap;
+} StringDict;
+
+// Rows scanned by one worker, with dictionaries local to the worker
+typedef struct
+{
+    ScanList *list;
+    int first;
+    int last;
+    int rows;
+    int failed;
+    off_t bytes;
+    StringDict dict[EXPORT_STRING_COLUMNS];
+    unsigned int *codes[EXPORT_STRING_COLUMNS];
+    unsigned int *duration;
+} ExportChunk;
+
+static const unsigned short mpeg_bitrates[2][3][16] = {
+    {{0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448, 0},
+     {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 0},
+     {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0}},
+    {{0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256, 0},
+     {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0},
+     {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0}}};
+
+static const unsigned int mpeg_sample_rates[4][3] = {
+    {11025, 12000, 8000}, // MPEG 2.5
+    {0, 0, 0},            // Reserved
+    {22050, 24000, 16000}, // MPEG 2
+    {44100, 48000, 32000}}; // MPEG 1
+
+static unsigned int read_be32(const unsigned char *p)
+{
+    return (unsigned int)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+unsigned int audio_duration_ms(int fd, off_t audio_offset)
+{
+    unsigned char buffer[4096];
+    struct stat st;
+
+    ssize_t n = pread(fd, buffer, sizeof(buffer), audio_offset);
+    if (n < 4 || fstat(fd, &st) != 0)
+        return 0;
+
+    // First valid MPEG audio frame header after the tag
+    for (ssize_t i = 0; i + 4 <= n; i++)
+    {
+        if (buffer[i] != 0xFF || (buffer[i + 1] & 0xE0) != 0xE0)
+            continue;
+
+        int version = (buffer[i + 1] >> 3) & 3; // 3 = MPEG 1, 2 = MPEG 2, 0 = MPEG 2.5
+        int layer = 3 - ((buffer[i + 1] >> 1) & 3); // 0 = Layer I .. 2 = Layer III
+        int bitrate_index = buffer[i + 2] >> 4;
+        int rate_index = (buffer[i + 2] >> 2) & 3;
+        if (version == 1 || layer == 3 || bitrate_index == 0 || bitrate_index == 15 || rate_index == 3)
+            continue;
+
+        int mpeg1 = (version == 3);
+        int mono = (buffer[i + 3] >> 6) == 3;
+        unsigned int kbps = mpeg_bitrates[!mpeg1][layer][bitrate_index];
+        unsigned int rate = mpeg_sample_rates[version][rate_index];
+        unsigned int samples = (layer == 0) ? 384 : (layer == 1 || mpeg1) ? 1152 : 576;
+
+        // VBR files carry the frame count in a Xing/Info or VBRI header inside the first frame
+        unsigned long long frames = 0;
+        ssize_t xing = i + 4 + (mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17));
+        ssize_t vbri = i + 4 + 32;
+        if (xing + 12 <= n && (memcmp(&buffer[xing], "Xing", 4) == 0 || memcmp(&buffer[xing], "Info", 4) == 0) &&
+            (read_be32(&buffer[xing + 4]) & 1))
+            frames = read_be32(&buffer[xing + 8]);
+        else if (vbri + 18 <= n && memcmp(&buffer[vbri], "VBRI", 4) == 0)
+            frames = read_be32(&buffer[vbri + 14]);
+
+        if (frames > 0)
+            return (unsigned int)(frames * samples * 1000 / rate);
+
+        // Constant bitrate: audio bytes over the bitrate, without an ID3v1 trailer
+        long long bytes = (long long)st.st_size - (audio_offset + i);
+        unsigned char trailer[3];
+        if (st.st_size >= 128 && pread(fd, trailer, 3, st.st_size - 128) == 3 && memcmp(trailer, "TAG", 3) == 0)
+            bytes -= 128;
+        return bytes > 0 ? (unsigned int)(bytes * 8 / kbps) : 0;
+    }
+
+    return 0;
+}
+
+static unsigned int hash_bytes(const char *s, size_t len)
+{
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static Status dict_rehash(StringDict *dict)
+{
+    unsigned int cap = dict->slot_cap ? dict->slot_cap * 2 : 256;
+    unsigned int *slots = calloc(cap, sizeof(unsigned int));
+    if (slots == NULL)
+        return failure;
+
+    for (unsigned int code = 0; code < dict->count; code++)
+    {
+        unsigned int start = dict->offsets[code];
+        unsigned int slot = hash_bytes(dict->data + start, dict->offsets[code + 1] - start) & (cap - 1);
+        while (slots[slot] != 0)
+            slot = (slot + 1) & (cap - 1);
+        slots[slot] = code + 1;
+    }
+
+    free(dict->slots);
+    dict->slots = slots;
+    dict->slot_cap = cap;
+    return success;
+}
+
+// Returns the code of the string, adding it when new
+static Status dict_add(StringDict *dict, const char *s, size_t len, unsigned int *code)
+{
+    if ((dict->count + 1) * 2 > dict->slot_cap && dict_rehash(dict) != success)
+        return failure;
+
+    unsigned int slot = hash_bytes(s, len) & (dict->slot_cap - 1);
+    while (dict->slots[slot] != 0)
+    {
+        unsigned int c = dict->slots[slot] - 1;
+        unsigned int start = dict->offsets[c];
+        if (dict->offsets[c + 1] - start == len && (len == 0 || memcmp(dict->data + start, s, len) == 0))
+        {
+            *code = c;
+            return success;
+        }
+        slot = (slot + 1) & (dict->slot_cap - 1);
+    }
+
+    if (dict->count + 2 > dict->cap)
+    {
+        unsigned int cap = dict->cap ? dict->cap * 2 : 256;
+        unsigned int *offsets = realloc(dict->offsets, cap * sizeof(unsigned int));
+        if (offsets == NULL)
+            return failure;
+        if (dict->cap == 0)
+            offsets[0] = 0;
+        dict->offsets = offsets;
+        dict->cap = cap;
+    }
+    if (dict->data_len + len > dict->data_cap)
+    {
+        size_t cap = dict->data_cap ? dict->data_cap : 4096;
+        while (cap < dict->data_len + len)
+            cap *= 2;
+        char *data = realloc(dict->data, cap);
+        if (data == NULL)
+            return failure;
+        dict->data = data;
+        dict->data_cap = cap;
+    }
+
+    if (len > 0) // No blob is allocated until the first non-empty value
+        memcpy(dict->data + dict->data_len, s, len);
+    dict->data_len += len;
+    dict->offsets[dict->count + 1] = (unsigned int)dict->data_len;
+    dict->slots[slot] = dict->count + 1;
+    *code = dict->count++;
+    return success;
+}
+
+static void dict_free(StringDict *dict)
+{
+    free(dict->data);
+    free(dict->offsets);
+    free(dict->slots);
+    memset(dict, 0, sizeof(*dict));
+}
+
+static void *export_worker(void *arg)
+{
+    ExportChunk *chunk = arg;
+    TagRecord record;
+    int count = chunk->last - chunk->first;
+
+    for (int c = 0; c < EXPORT_STRING_COLUMNS; c++)
+        chunk->codes[c] = malloc((count ? count : 1) * sizeof(unsigned int));
+    chunk->duration = malloc((count ? count : 1) * sizeof(unsigned int));
+
+    for (int i = chunk->first; i < chunk->last; i++)
+    {
+        // Same lookahead window as the single-threaded scan, within this worker's range
+        for (int j = i + 1; j < chunk->last && j <= i + SCAN_LOOKAHEAD; j++)
+            prefetch_entry(&chunk->list->entries[j]);
+
+        if (scan_file(&chunk->list->entries[i], &record, &chunk->bytes, 1) != success)
+        {
+            chunk->failed++;
+            continue;
+        }
+
+        // Values go straight into the dictionaries, no row text is formatted
+        int row = chunk->rows;
+        Status status = success;
+        for (int c = 0; c < EXPORT_STRING_COLUMNS && status == success; c++)
+        {
+            const char *value = (c == EXPORT_PATH_COLUMN) ? chunk->list->entries[i].path : record.value[c];
+            if (chunk->codes[c] == NULL || dict_add(&chunk->dict[c], value, strlen(value), &chunk->codes[c][row]) != success)
+                status = failure;
+        }
+        if (status != success || chunk->duration == NULL)
+        {
+            fprintf(stderr, "❌ Memory allocation failed.\n");
+            chunk->failed += chunk->last - i;
+            break;
+        }
+        chunk->duration[row] = record.duration_ms;
+        chunk->rows++;
+    }
+
+    return NULL;
+}
+
+static void put_u32(FILE *fp, unsigned int value)
+{
+    unsigned char bytes[4] = {value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, value >> 24};
+    fwrite(bytes, 1, 4, fp);
+}
+
+static void put_name(FILE *fp, const char *name, unsigned char encoding)
+{
+    fputc((int)strlen(name), fp);
+    fputs(name, fp);
+    fputc(encoding, fp);
+}
+
+// Merges the chunk dictionaries of one column in chunk order and writes it
+static Status write_string_column(FILE *fp, ExportChunk *chunks, int nchunks, int column)
+{
+    StringDict global = {0};
+    unsigned int *remap[EXPORT_MAX_THREADS] = {0};
+    Status status = success;
+
+    for (int t = 0; t < nchunks && status == success; t++)
+    {
+        StringDict *local = &chunks[t].dict[column];
+        remap[t] = malloc((local->count ? local->count : 1) * sizeof(unsigned int));
+        if (remap[t] == NULL)
+            status = failure;
+        for (unsigned int c = 0; c < local->count && status == success; c++)
+            status = dict_add(&global, local->data + local->offsets[c], local->offsets[c + 1] - local->offsets[c], &remap[t][c]);
+    }
+
+    if (status == success)
+    {
+        put_name(fp, export_column_names[column], 1);
+        put_u32(fp, global.count);
+        put_u32(fp, (unsigned int)global.data_len);
+        for (unsigned int c = 0; c <= global.count; c++)
+            put_u32(fp, global.count ? global.offsets[c] : 0);
+        fwrite(global.data, 1, global.data_len, fp);
+
+        for (int t = 0; t < nchunks; t++)
+            for (int r = 0; r < chunks[t].rows; r++)
+                put_u32(fp, remap[t][chunks[t].codes[column][r]]);
+
+        printf("   %-12s: %u distinct value(s), %zu bytes of strings\n", export_column_names[column], global.count, global.data_len);
+    }
+    else
+    {
+        fprintf(stderr, "❌ Memory allocation failed.\n");
+    }
+
+    for (int t = 0; t < nchunks; t++)
+        free(remap[t]);
+    dict_free(&global);
+    return status;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+Status export_columns(int argc, char *argv[])
+{
+    const char *out_path = argv[2];
+    long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    ScanList list = {0};
+    Status status = success;
+
+    for (int i = 3; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            nthreads = atol(argv[++i]);
+        else if (collect_mp3_files(argv[i], &list) != success)
+            status = failure;
+    }
+
+    if (list.count == 0)
+    {
+        fprintf(stderr, "❌ Error: No MP3 files found\n");
+        free_scan_list(&list);
+        return failure;
+    }
+
+    if (nthreads < 1)
+        nthreads = 1;
+    if (nthreads > EXPORT_MAX_THREADS)
+        nthreads = EXPORT_MAX_THREADS;
+    if (nthreads > list.count)
+        nthreads = list.count;
+
+    // Each worker holds its file and up to SCAN_LOOKAHEAD prefetched ones open
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+    {
+        long fit = ((long)limit.rlim_cur - EXPORT_SPARE_FDS) / (SCAN_LOOKAHEAD + 1);
+        if (fit < 1)
+            fit = 1;
+        if (nthreads > fit)
+        {
+            printf("ℹ️  Using %ld thread(s), the open file limit is %llu\n", fit, (unsigned long long)limit.rlim_cur);
+            nthreads = fit;
+        }
+    }
+
+    double start = now_seconds();
+    sort_by_disk_location(&list);
+
+    // Contiguous slices of the disk order, so concatenating the chunks keeps the row order
+    ExportChunk chunks[EXPORT_MAX_THREADS];
+    pthread_t threads[EXPORT_MAX_THREADS];
+    int started[EXPORT_MAX_THREADS] = {0};
+    memset(chunks, 0, sizeof(chunks));
+    for (int t = 0; t < nthreads; t++)
+    {
+        chunks[t].list = &list;
+        chunks[t].first = (int)((long long)list.count * t / nthreads);
+        chunks[t].last = (int)((long long)list.count * (t + 1) / nthreads);
+        started[t] = (pthread_create(&threads[t], NULL, export_worker, &chunks[t]) == 0);
+        if (!started[t])
+            export_worker(&chunks[t]); // Out of threads: do this slice here
+    }
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (started[t])
+            pthread_join(threads[t], NULL);
+    }
+    double scanned = now_seconds();
+
+    int rows = 0, failed = 0;
+    off_t bytes = 0;
+    for (int t = 0; t < nthreads; t++)
+    {
+        rows += chunks[t].rows;
+        failed += chunks[t].failed;
+        bytes += chunks[t].bytes;
+    }
+
+    FILE *fp = fopen(out_path, "wb");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "❌ Error: Unable to create '%s': %s\n", out_path, strerror(errno));
+        status = failure;
+    }
+    else
+    {
+        printf("📦 Writing %d row(s) to %s\n", rows, out_path);
+        fwrite("MP3COLS1", 1, 8, fp);
+        put_u32(fp, rows);
+        put_u32(fp, EXPORT_STRING_COLUMNS + 1);
+
+        Status written = success;
+        for (int c = 0; c < EXPORT_STRING_COLUMNS && written == success; c++)
+            written = write_string_column(fp, chunks, nthreads, c);
+
+        put_name(fp, export_column_names[EXPORT_STRING_COLUMNS], 0);
+        for (int t = 0; t < nthreads; t++)
+            for (int r = 0; r < chunks[t].rows; r++)
+                put_u32(fp, chunks[t].duration[r]);
+
+        // A partial export would look like a valid file with missing columns, it is removed unless the
+        // output is a device or pipe
+        struct stat st;
+        int regular = (fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode));
+        if (ferror(fp))
+            written = failure;
+        if (fclose(fp) != 0 || written != success)
+        {
+            fprintf(stderr, "❌ Error: Unable to write '%s'\n", out_path);
+            if (regular)
+                unlink(out_path);
+            status = failure;
+        }
+    }
+
+    double elapsed = now_seconds() - start;
+    printf("⏱️  Scanned %d file(s) with %ld thread(s) in %.3f s, export written in %.3f s (%.2f MB of tag data)\n",
+           list.count, nthreads, scanned - start, elapsed - (scanned - start), bytes / (1024.0 * 1024.0));
+    if (failed > 0)
+    {
+        fprintf(stderr, "⚠️  %d file(s) could not be read and were left out\n", failed);
+        status = failure;
+    }
+
+    for (int t = 0; t < nthreads; t++)
+    {
+        for (int c = 0; c < EXPORT_STRING_COLUMNS; c++)
+        {
+            dict_free(&chunks[t].dict[c]);
+            free(chunks[t].codes[c]);
+        }
+        free(chunks[t].duration);
+    }
+    free_scan_list(&list);
+    return status;
+}
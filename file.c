@@ -7,6 +7,8 @@ Description : MP3 Tag Reader project
 
 #include "mp3_tag_reader.h"
 #include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 Status open_mp3_file_view(TagOperationInfo *tagopinfo)
 {
@@ -52,11 +54,33 @@ Status open_mp3_file_edit(TagOperationInfo *tagopinfo)
     printf("📄 Original MP3 file opened successfully: %s\n", tagopinfo->filename);
 
     // Set new filename for modified MP3
-    tagopinfo->new_filename = "new.mp3";
-    tagopinfo->fptr_new_mp3 = fopen(tagopinfo->new_filename, "w");
+    // Keep it next to the original so the audio can be reflinked and renamed on the same filesystem,
+    // under a unique name so no other track in the directory is overwritten
+    if (strlen(tagopinfo->filename) + strlen(".XXXXXX") >= sizeof(tagopinfo->new_path))
+    {
+        fprintf(stderr, "❌ Error: File path '%s' is too long.\n", tagopinfo->filename);
+        return failure;
+    }
+    snprintf(tagopinfo->new_path, sizeof(tagopinfo->new_path), "%s.XXXXXX", tagopinfo->filename);
+    int fd = mkstemp(tagopinfo->new_path);
+    if (fd < 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to create a temporary file next to '%s'.\n", tagopinfo->filename);
+        return failure;
+    }
+    tagopinfo->new_filename = tagopinfo->new_path;
+
+    // mkstemp creates the file 0600, the result keeps the permissions of the original
+    struct stat st;
+    if (fstat(fileno(tagopinfo->fptr_mp3), &st) == 0)
+        fchmod(fd, st.st_mode & 07777);
+
+    tagopinfo->fptr_new_mp3 = fdopen(fd, "w+"); // Readable for --verify
     if (tagopinfo->fptr_new_mp3 == NULL)
     {
-        fprintf(stderr, "❌ Error: Unable to open file '%s'. Please check if the file exists and is accessible.\n", tagopinfo->filename);
+        fprintf(stderr, "❌ Error: Unable to open file '%s'.\n", tagopinfo->new_filename);
+        close(fd);
+        remove(tagopinfo->new_filename);
         return failure;
     }
     printf("🆕 New MP3 file opened successfully: %s\n", tagopinfo->new_filename);
@@ -103,19 +127,10 @@ Status rename_mp3_file(TagOperationInfo *tagopinfo)
 {
     printf("\n🔄 Renaming the file ...\n");
 
-    if (remove(tagopinfo->filename) == 0)
-    {
-        printf("🗑️  Original MP3 file '%s' removed successfully\n", tagopinfo->filename);
-    }
-    else
-    {
-        perror("❌ Failed to remove original MP3 file");
-        return failure;
-    }
-
+    // rename replaces the original in one step, a crash leaves either the old or the new file in place
     if (rename(tagopinfo->new_filename, tagopinfo->filename) == 0)
     {
-        printf("✏️  Renamed '%s' to 'sample.mp3' successfully.\n", tagopinfo->new_filename);
+        printf("✏️  Renamed '%s' to '%s' successfully.\n", tagopinfo->new_filename, tagopinfo->filename);
         printf("✅ File rename operation completed successfully\n");
         return success;
     }
@@ -0,0 +1,491 @@
+/*
+Documentation
+Name        : Vamsi T
+Date        : 30/7/25
+Description : MP3 Tag Reader project - frame registry for ID3v2.2 / v2.3 / v2.4
+*/
+
+#include "mp3_tag_reader.h"
+#include <stdint.h>
+
+/*
+Every standard frame ID, one line per frame:
+X(name, id0, id1, id2, id3, versions, type, record field, edit option, description)
+v2.2 IDs are 3 characters, id3 is 0 for them.
+*/
+#define FRAME_LIST(X) \
+    X(AENC, 'A', 'E', 'N', 'C', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Audio encryption")                  \
+    X(APIC, 'A', 'P', 'I', 'C', ID3_V23 | ID3_V24, FRAME_PICTURE, FIELD_NONE, 0, "Attached picture")                 \
+    X(ASPI, 'A', 'S', 'P', 'I', ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Audio seek point index")                      \
+    X(COMM, 'C', 'O', 'M', 'M', ID3_V23 | ID3_V24, FRAME_COMMENT, FIELD_COMMENT, 'm', "Comment")                     \
+    X(COMR, 'C', 'O', 'M', 'R', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Commercial frame")                  \
+    X(ENCR, 'E', 'N', 'C', 'R', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Encryption method registration")    \
+    X(EQUA, 'E', 'Q', 'U', 'A', ID3_V23, FRAME_BINARY, FIELD_NONE, 0, "Equalization")                                \
+    X(EQU2, 'E', 'Q', 'U', '2', ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Equalisation (2)")                            \
+    X(ETCO, 'E', 'T', 'C', 'O', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Event timing codes")                \
+    X(GEOB, 'G', 'E', 'O', 'B', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "General encapsulated object")       \
+    X(GRID, 'G', 'R', 'I', 'D', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Group identification registration") \
+    X(IPLS, 'I', 'P', 'L', 'S', ID3_V23, FRAME_TEXT, FIELD_NONE, 0, "Involved people list")                          \
+    X(LINK, 'L', 'I', 'N', 'K', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Linked information")                \
+    X(MCDI, 'M', 'C', 'D', 'I', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Music CD identifier")               \
+    X(MLLT, 'M', 'L', 'L', 'T', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "MPEG location lookup table")        \
+    X(OWNE, 'O', 'W', 'N', 'E', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Ownership frame")                   \
+    X(PRIV, 'P', 'R', 'I', 'V', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Private frame")                     \
+    X(PCNT, 'P', 'C', 'N', 'T', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Play counter")                      \
+    X(POPM, 'P', 'O', 'P', 'M', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Popularimeter")                     \
+    X(POSS, 'P', 'O', 'S', 'S', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Position synchronisation frame")    \
+    X(RBUF, 'R', 'B', 'U', 'F', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Recommended buffer size")           \
+    X(RVAD, 'R', 'V', 'A', 'D', ID3_V23, FRAME_BINARY, FIELD_NONE, 0, "Relative volume adjustment")                  \
+    X(RVA2, 'R', 'V', 'A', '2', ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Relative volume adjustment (2)")              \
+    X(RVRB, 'R', 'V', 'R', 'B', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Reverb")                            \
+    X(SEEK, 'S', 'E', 'E', 'K', ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Seek frame")                                  \
+    X(SIGN, 'S', 'I', 'G', 'N', ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Signature frame")                             \
+    X(SYLT, 'S', 'Y', 'L', 'T', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Synchronised lyric/text")           \
+    X(SYTC, 'S', 'Y', 'T', 'C', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Synchronised tempo codes")          \
+    X(TALB, 'T', 'A', 'L', 'B', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_ALBUM, 'A', "Album")                            \
+    X(TBPM, 'T', 'B', 'P', 'M', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "BPM")                                 \
+    X(TCOM, 'T', 'C', 'O', 'M', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Composer")                            \
+    X(TCON, 'T', 'C', 'O', 'N', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_GENRE, 'c', "Genre")                            \
+    X(TCOP, 'T', 'C', 'O', 'P', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Copyright message")                   \
+    X(TDAT, 'T', 'D', 'A', 'T', ID3_V23, FRAME_TEXT, FIELD_NONE, 0, "Date")                                          \
+    X(TDEN, 'T', 'D', 'E', 'N', ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Encoding time")                                 \
+    X(TDLY, 'T', 'D', 'L', 'Y', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Playlist delay")                      \
+    X(TDOR, 'T', 'D', 'O', 'R', ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Original release time")                         \
+    X(TDRC, 'T', 'D', 'R', 'C', ID3_V24, FRAME_TEXT, FIELD_YEAR, 'y', "Recording time")                              \
+    X(TDRL, 'T', 'D', 'R', 'L', ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Release time")                                  \
+    X(TDTG, 'T', 'D', 'T', 'G', ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Tagging time")                                  \
+    X(TENC, 'T', 'E', 'N', 'C', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Encoded by")                          \
+    X(TEXT, 'T', 'E', 'X', 'T', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Lyricist/Text writer")                \
+    X(TFLT, 'T', 'F', 'L', 'T', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "File type")                           \
+    X(TIME, 'T', 'I', 'M', 'E', ID3_V23, FRAME_TEXT, FIELD_NONE, 0, "Time")                                          \
+    X(TIPL, 'T', 'I', 'P', 'L', ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Involved people list")                          \
+    X(TIT1, 'T', 'I', 'T', '1', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Content group description")           \
+    X(TIT2, 'T', 'I', 'T', '2', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_TITLE, 't', "Title")                            \
+    X(TIT3, 'T', 'I', 'T', '3', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Subtitle")                            \
+    X(TKEY, 'T', 'K', 'E', 'Y', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Initial key")                         \
+    X(TLAN, 'T', 'L', 'A', 'N', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Language")                            \
+    X(TLEN, 'T', 'L', 'E', 'N', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Length")                              \
+    X(TMCL, 'T', 'M', 'C', 'L', ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Musician credits list")                         \
+    X(TMED, 'T', 'M', 'E', 'D', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Media type")                          \
+    X(TMOO, 'T', 'M', 'O', 'O', ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Mood")                                          \
+    X(TOAL, 'T', 'O', 'A', 'L', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Original album")                      \
+    X(TOFN, 'T', 'O', 'F', 'N', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Original filename")                   \
+    X(TOLY, 'T', 'O', 'L', 'Y', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Original lyricist")                   \
+    X(TOPE, 'T', 'O', 'P', 'E', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Original artist")                     \
+    X(TORY, 'T', 'O', 'R', 'Y', ID3_V23, FRAME_TEXT, FIELD_NONE, 0, "Original release year")                         \
+    X(TOWN, 'T', 'O', 'W', 'N', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "File owner/licensee")                 \
+    X(TPE1, 'T', 'P', 'E', '1', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_ARTIST, 'a', "Artist")                          \
+    X(TPE2, 'T', 'P', 'E', '2', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Band/Orchestra")                      \
+    X(TPE3, 'T', 'P', 'E', '3', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Conductor")                           \
+    X(TPE4, 'T', 'P', 'E', '4', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Remixed by")                          \
+    X(TPOS, 'T', 'P', 'O', 'S', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Part of a set")                       \
+    X(TPRO, 'T', 'P', 'R', 'O', ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Produced notice")                               \
+    X(TPUB, 'T', 'P', 'U', 'B', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Publisher")                           \
+    X(TRCK, 'T', 'R', 'C', 'K', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Track number")                        \
+    X(TRDA, 'T', 'R', 'D', 'A', ID3_V23, FRAME_TEXT, FIELD_NONE, 0, "Recording dates")                               \
+    X(TRSN, 'T', 'R', 'S', 'N', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Internet radio station name")         \
+    X(TRSO, 'T', 'R', 'S', 'O', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Internet radio station owner")        \
+    X(TSIZ, 'T', 'S', 'I', 'Z', ID3_V23, FRAME_TEXT, FIELD_NONE, 0, "Size")                                          \
+    X(TSOA, 'T', 'S', 'O', 'A', ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Album sort order")                              \
+    X(TSOP, 'T', 'S', 'O', 'P', ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Performer sort order")                          \
+    X(TSOT, 'T', 'S', 'O', 'T', ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Title sort order")                              \
+    X(TSRC, 'T', 'S', 'R', 'C', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "ISRC")                                \
+    X(TSSE, 'T', 'S', 'S', 'E', ID3_V23 | ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Encoding settings")                   \
+    X(TSST, 'T', 'S', 'S', 'T', ID3_V24, FRAME_TEXT, FIELD_NONE, 0, "Set subtitle")                                  \
+    X(TYER, 'T', 'Y', 'E', 'R', ID3_V23, FRAME_TEXT, FIELD_YEAR, 'y', "Year")                                        \
+    X(TXXX, 'T', 'X', 'X', 'X', ID3_V23 | ID3_V24, FRAME_USER_TEXT, FIELD_NONE, 0, "User defined text")              \
+    X(UFID, 'U', 'F', 'I', 'D', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Unique file identifier")            \
+    X(USER, 'U', 'S', 'E', 'R', ID3_V23 | ID3_V24, FRAME_BINARY, FIELD_NONE, 0, "Terms of use")                      \
+    X(USLT, 'U', 'S', 'L', 'T', ID3_V23 | ID3_V24, FRAME_COMMENT, FIELD_NONE, 0, "Unsynchronised lyrics")            \
+    X(WCOM, 'W', 'C', 'O', 'M', ID3_V23 | ID3_V24, FRAME_URL, FIELD_NONE, 0, "Commercial information")               \
+    X(WCOP, 'W', 'C', 'O', 'P', ID3_V23 | ID3_V24, FRAME_URL, FIELD_NONE, 0, "Copyright information")                \
+    X(WOAF, 'W', 'O', 'A', 'F', ID3_V23 | ID3_V24, FRAME_URL, FIELD_NONE, 0, "Official audio file webpage")          \
+    X(WOAR, 'W', 'O', 'A', 'R', ID3_V23 | ID3_V24, FRAME_URL, FIELD_NONE, 0, "Official artist webpage")              \
+    X(WOAS, 'W', 'O', 'A', 'S', ID3_V23 | ID3_V24, FRAME_URL, FIELD_NONE, 0, "Official audio source webpage")        \
+    X(WORS, 'W', 'O', 'R', 'S', ID3_V23 | ID3_V24, FRAME_URL, FIELD_NONE, 0, "Official radio station homepage")      \
+    X(WPAY, 'W', 'P', 'A', 'Y', ID3_V23 | ID3_V24, FRAME_URL, FIELD_NONE, 0, "Payment")                              \
+    X(WPUB, 'W', 'P', 'U', 'B', ID3_V23 | ID3_V24, FRAME_URL, FIELD_NONE, 0, "Publisher webpage")                    \
+    X(WXXX, 'W', 'X', 'X', 'X', ID3_V23 | ID3_V24, FRAME_USER_URL, FIELD_NONE, 0, "User defined URL")                \
+    X(BUF, 'B', 'U', 'F', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Recommended buffer size")                        \
+    X(CNT, 'C', 'N', 'T', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Play counter")                                   \
+    X(COM, 'C', 'O', 'M', 0, ID3_V22, FRAME_COMMENT, FIELD_COMMENT, 0, "Comment")                                    \
+    X(CRA, 'C', 'R', 'A', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Audio encryption")                               \
+    X(CRM, 'C', 'R', 'M', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Encrypted meta frame")                           \
+    X(ETC, 'E', 'T', 'C', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Event timing codes")                             \
+    X(EQU, 'E', 'Q', 'U', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Equalization")                                   \
+    X(GEO, 'G', 'E', 'O', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "General encapsulated object")                    \
+    X(IPL, 'I', 'P', 'L', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Involved people list")                             \
+    X(LNK, 'L', 'N', 'K', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Linked information")                             \
+    X(MCI, 'M', 'C', 'I', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Music CD identifier")                            \
+    X(MLL, 'M', 'L', 'L', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "MPEG location lookup table")                     \
+    X(PIC, 'P', 'I', 'C', 0, ID3_V22, FRAME_PICTURE, FIELD_NONE, 0, "Attached picture")                              \
+    X(POP, 'P', 'O', 'P', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Popularimeter")                                  \
+    X(REV, 'R', 'E', 'V', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Reverb")                                         \
+    X(RVA, 'R', 'V', 'A', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Relative volume adjustment")                     \
+    X(SLT, 'S', 'L', 'T', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Synchronised lyric/text")                        \
+    X(STC, 'S', 'T', 'C', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Synced tempo codes")                             \
+    X(TAL, 'T', 'A', 'L', 0, ID3_V22, FRAME_TEXT, FIELD_ALBUM, 0, "Album")                                           \
+    X(TBP, 'T', 'B', 'P', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "BPM")                                              \
+    X(TCM, 'T', 'C', 'M', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Composer")                                         \
+    X(TCO, 'T', 'C', 'O', 0, ID3_V22, FRAME_TEXT, FIELD_GENRE, 0, "Genre")                                           \
+    X(TCR, 'T', 'C', 'R', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Copyright message")                                \
+    X(TDA, 'T', 'D', 'A', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Date")                                             \
+    X(TDY, 'T', 'D', 'Y', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Playlist delay")                                   \
+    X(TEN, 'T', 'E', 'N', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Encoded by")                                       \
+    X(TFT, 'T', 'F', 'T', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "File type")                                        \
+    X(TIM, 'T', 'I', 'M', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Time")                                             \
+    X(TKE, 'T', 'K', 'E', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Initial key")                                      \
+    X(TLA, 'T', 'L', 'A', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Language")                                         \
+    X(TLE, 'T', 'L', 'E', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Length")                                           \
+    X(TMT, 'T', 'M', 'T', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Media type")                                       \
+    X(TOA, 'T', 'O', 'A', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Original artist")                                  \
+    X(TOF, 'T', 'O', 'F', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Original filename")                                \
+    X(TOL, 'T', 'O', 'L', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Original lyricist")                                \
+    X(TOR, 'T', 'O', 'R', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Original release year")                            \
+    X(TOT, 'T', 'O', 'T', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Original album")                                   \
+    X(TP1, 'T', 'P', '1', 0, ID3_V22, FRAME_TEXT, FIELD_ARTIST, 0, "Artist")                                         \
+    X(TP2, 'T', 'P', '2', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Band/Orchestra")                                   \
+    X(TP3, 'T', 'P', '3', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Conductor")                                        \
+    X(TP4, 'T', 'P', '4', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Remixed by")                                       \
+    X(TPA, 'T', 'P', 'A', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Part of a set")                                    \
+    X(TPB, 'T', 'P', 'B', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Publisher")                                        \
+    X(TRC, 'T', 'R', 'C', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "ISRC")                                             \
+    X(TRD, 'T', 'R', 'D', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Recording dates")                                  \
+    X(TRK, 'T', 'R', 'K', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Track number")                                     \
+    X(TSI, 'T', 'S', 'I', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Size")                                             \
+    X(TSS, 'T', 'S', 'S', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Encoding settings")                                \
+    X(TT1, 'T', 'T', '1', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Content group description")                        \
+    X(TT2, 'T', 'T', '2', 0, ID3_V22, FRAME_TEXT, FIELD_TITLE, 0, "Title")                                           \
+    X(TT3, 'T', 'T', '3', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Subtitle")                                         \
+    X(TXT, 'T', 'X', 'T', 0, ID3_V22, FRAME_TEXT, FIELD_NONE, 0, "Lyricist/Text writer")                             \
+    X(TXX, 'T', 'X', 'X', 0, ID3_V22, FRAME_USER_TEXT, FIELD_NONE, 0, "User defined text")                           \
+    X(TYE, 'T', 'Y', 'E', 0, ID3_V22, FRAME_TEXT, FIELD_YEAR, 0, "Year")                                             \
+    X(UFI, 'U', 'F', 'I', 0, ID3_V22, FRAME_BINARY, FIELD_NONE, 0, "Unique file identifier")                         \
+    X(ULT, 'U', 'L', 'T', 0, ID3_V22, FRAME_COMMENT, FIELD_NONE, 0, "Unsynchronised lyrics")                         \
+    X(WAF, 'W', 'A', 'F', 0, ID3_V22, FRAME_URL, FIELD_NONE, 0, "Official audio file webpage")                       \
+    X(WAR, 'W', 'A', 'R', 0, ID3_V22, FRAME_URL, FIELD_NONE, 0, "Official artist webpage")                           \
+    X(WAS, 'W', 'A', 'S', 0, ID3_V22, FRAME_URL, FIELD_NONE, 0, "Official audio source webpage")                     \
+    X(WCM, 'W', 'C', 'M', 0, ID3_V22, FRAME_URL, FIELD_NONE, 0, "Commercial information")                            \
+    X(WCP, 'W', 'C', 'P', 0, ID3_V22, FRAME_URL, FIELD_NONE, 0, "Copyright information")                             \
+    X(WPB, 'W', 'P', 'B', 0, ID3_V22, FRAME_URL, FIELD_NONE, 0, "Publisher webpage")                                 \
+    X(WXX, 'W', 'X', 'X', 0, ID3_V22, FRAME_USER_URL, FIELD_NONE, 0, "User defined URL")                            
+
+// Perfect hash: the 4 ID bytes as one big-endian 32-bit integer, multiplied and shifted into 1024 slots.
+// The multiplier was searched offline so that no two IDs in FRAME_LIST share a slot.
+#define FRAME_HASH_BITS 10
+#define FRAME_HASH_MULT 0x77de6f11u
+#define FRAME_KEY(a, b, c, d) (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(c) << 8) | (uint32_t)(d))
+#define FRAME_HASH(key) ((uint32_t)((key) * FRAME_HASH_MULT) >> (32 - FRAME_HASH_BITS))
+
+// Registry index of every frame
+#define FRAME_ENUM(name, a, b, c, d, versions, type, field, option, description) FID_##name,
+enum
+{
+    FRAME_LIST(FRAME_ENUM) FRAME_COUNT
+};
+
+static void decode_text(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len);
+static void decode_user_text(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len);
+static void decode_url(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len);
+static void decode_user_url(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len);
+static void decode_comment(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len);
+static void decode_picture(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len);
+static void decode_binary(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len);
+static unsigned int encode_text(const char *value, unsigned char version, unsigned char *out, unsigned int out_len);
+static unsigned int encode_comment(const char *value, unsigned char version, unsigned char *out, unsigned int out_len);
+static unsigned int encode_url(const char *value, unsigned char version, unsigned char *out, unsigned int out_len);
+
+// Decoder and encoder for each frame type, in FrameType order
+static const struct
+{
+    FrameDecoder decode;
+    FrameEncoder encode;
+} frame_handlers[] = {
+    {decode_text, encode_text},         // FRAME_TEXT
+    {decode_user_text, NULL},           // FRAME_USER_TEXT
+    {decode_url, encode_url},           // FRAME_URL
+    {decode_user_url, NULL},            // FRAME_USER_URL
+    {decode_comment, encode_comment},   // FRAME_COMMENT
+    {decode_picture, NULL},             // FRAME_PICTURE
+    {decode_binary, NULL},              // FRAME_BINARY
+};
+
+#define FRAME_ENTRY(name, a, b, c, d, versions, type, field, option, description) \
+    {{a, b, c, d, 0}, versions, type, field, option, description},
+static const FrameInfo frame_registry[FRAME_COUNT] = {FRAME_LIST(FRAME_ENTRY)};
+
+// Slot -> registry index + 1, 0 for an empty slot. Built by the compiler from the same list.
+#define FRAME_SLOT(name, a, b, c, d, versions, type, field, option, description) \
+    [FRAME_HASH(FRAME_KEY(a, b, c, d))] = FID_##name + 1,
+static const unsigned char frame_slots[1 << FRAME_HASH_BITS] = {FRAME_LIST(FRAME_SLOT)};
+
+_Static_assert(FRAME_COUNT < 256, "frame_slots stores indexes in one byte");
+
+const FrameInfo *lookup_frame(const unsigned char *id, int id_len)
+{
+    uint32_t key = FRAME_KEY(id[0], id[1], id[2], id_len == 3 ? 0 : id[3]);
+    int slot = frame_slots[FRAME_HASH(key)];
+
+    // One compare confirms the hit, an unknown ID can land on a used slot
+    if (slot == 0)
+        return NULL;
+
+    const FrameInfo *info = &frame_registry[slot - 1];
+    if (FRAME_KEY(info->id[0], info->id[1], info->id[2], info->id[3]) != key)
+        return NULL;
+    return info;
+}
+
+const FrameInfo *lookup_edit_option(char option, unsigned char version)
+{
+    // Only a handful of frames are editable, this runs once per command line.
+    // An option can map to a different frame per version (-y is TYER in v2.3, TDRC in v2.4), version 0 takes the first.
+    unsigned char mask = (version >= 2 && version <= 4) ? 1 << (version - 2) : 0;
+    for (int i = 0; i < FRAME_COUNT; i++)
+    {
+        if (option != 0 && frame_registry[i].option == option && (mask == 0 || (frame_registry[i].versions & mask)))
+            return &frame_registry[i];
+    }
+    return NULL;
+}
+
+FrameDecoder frame_decoder(const FrameInfo *info)
+{
+    return frame_handlers[info->type].decode;
+}
+
+FrameEncoder frame_encoder(const FrameInfo *info)
+{
+    return frame_handlers[info->type].encode;
+}
+
+static int is_wide(unsigned char encoding)
+{
+    return encoding == 1 || encoding == 2; // UTF-16 with BOM, UTF-16BE
+}
+
+// Skips one terminated string, returns the position after its terminator
+static unsigned int skip_string(const unsigned char *data, unsigned int size, unsigned int pos, unsigned char encoding)
+{
+    if (is_wide(encoding))
+    {
+        while (pos + 1 < size && (data[pos] != 0 || data[pos + 1] != 0))
+            pos += 2;
+        return pos + 2;
+    }
+
+    while (pos < size && data[pos] != 0)
+        pos++;
+    return pos + 1;
+}
+
+// Copies one string in the given encoding, non-ASCII UTF-16 becomes '?'
+static void copy_string(const unsigned char *data, unsigned int size, unsigned int pos, unsigned char encoding, char *out, int out_len)
+{
+    int len = 0;
+    int wide = is_wide(encoding);
+    int big_endian = (encoding == 2);
+
+    if (wide && pos + 1 < size && ((data[pos] == 0xFF && data[pos + 1] == 0xFE) || (data[pos] == 0xFE && data[pos + 1] == 0xFF)))
+    {
+        big_endian = (data[pos] == 0xFE); // Byte order mark
+        pos += 2;
+    }
+
+    while (pos < size && len < out_len - 1)
+    {
+        unsigned int ch;
+        if (wide)
+        {
+            if (pos + 1 >= size)
+                break;
+            ch = big_endian ? (data[pos] << 8 | data[pos + 1]) : (data[pos + 1] << 8 | data[pos]);
+            pos += 2;
+            if (ch > 0x7F)
+                ch = '?';
+        }
+        else
+        {
+            ch = data[pos++];
+        }
+
+        if (ch == 0)
+            break;
+        out[len++] = (ch < 32 || ch == 127) ? ' ' : ch; // No tabs or line breaks inside a record
+    }
+    out[len] = '\0';
+}
+
+static void decode_text(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len)
+{
+    (void)info;
+    out[0] = '\0';
+    if (size >= 1)
+        copy_string(data, size, 1, data[0], out, out_len);
+}
+
+static void decode_user_text(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len)
+{
+    (void)info;
+    out[0] = '\0';
+    if (size < 1)
+        return;
+
+    // <description>=<value>
+    copy_string(data, size, 1, data[0], out, out_len);
+    int len = strlen(out);
+    if (len < out_len - 1)
+    {
+        out[len++] = '=';
+        copy_string(data, size, skip_string(data, size, 1, data[0]), data[0], out + len, out_len - len);
+    }
+}
+
+static void decode_url(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len)
+{
+    (void)info;
+    copy_string(data, size, 0, 0, out, out_len); // Always ISO-8859-1, no encoding byte
+}
+
+static void decode_user_url(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len)
+{
+    (void)info;
+    out[0] = '\0';
+    if (size >= 1)
+        copy_string(data, size, skip_string(data, size, 1, data[0]), 0, out, out_len);
+}
+
+static void decode_comment(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len)
+{
+    (void)info;
+    out[0] = '\0';
+    if (size < 4)
+        return;
+
+    // Encoding, language, short description, then the text
+    copy_string(data, size, skip_string(data, size, 4, data[0]), data[0], out, out_len);
+}
+
+static void decode_picture(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len)
+{
+    out[0] = '\0';
+    if (size < 2)
+        return;
+
+    // v2.2 PIC has a 3-character image format, APIC a MIME type
+    if (info->id[3] == '\0')
+        copy_string(data, size < 4 ? size : 4, 1, 0, out, out_len);
+    else
+        copy_string(data, size, 1, 0, out, out_len);
+}
+
+static void decode_binary(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len)
+{
+    // Nothing printable, callers show the frame size instead
+    (void)info;
+    (void)data;
+    (void)size;
+    (void)out_len;
+    out[0] = '\0';
+}
+
+// Writes value as ISO-8859-1 when it is plain ASCII, otherwise UTF-8 (v2.4) or UTF-16 with BOM (v2.3)
+static unsigned int encode_string(const char *value, unsigned char version, unsigned char encoding, unsigned char *out, unsigned int out_len)
+{
+    unsigned int len = 0;
+    const unsigned char *s = (const unsigned char *)value;
+
+    // v2.4 allows UTF-8 (3), v2.3 needs UTF-16 (1), ASCII is written unchanged (0)
+    (void)version;
+    if (encoding != 1)
+    {
+        unsigned int n = strlen(value);
+        if (n > out_len)
+            return 0;
+        memcpy(out, value, n);
+        return n;
+    }
+
+    if (out_len < 2)
+        return 0;
+    out[len++] = 0xFF; // Little endian BOM
+    out[len++] = 0xFE;
+
+    while (*s)
+    {
+        unsigned int cp;
+        if (s[0] < 0x80)
+            cp = *s++;
+        else if ((s[0] & 0xE0) == 0xC0 && s[1])
+            cp = ((s[0] & 0x1F) << 6) | (s[1] & 0x3F), s += 2;
+        else if ((s[0] & 0xF0) == 0xE0 && s[1] && s[2])
+            cp = ((s[0] & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F), s += 3;
+        else if ((s[0] & 0xF8) == 0xF0 && s[1] && s[2] && s[3])
+            cp = ((s[0] & 0x07) << 18) | ((s[1] & 0x3F) << 12) | ((s[2] & 0x3F) << 6) | (s[3] & 0x3F), s += 4;
+        else
+            cp = '?', s++;
+
+        if (cp >= 0x10000)
+        {
+            // Surrogate pair
+            if (len + 4 > out_len)
+                return 0;
+            cp -= 0x10000;
+            unsigned int hi = 0xD800 | (cp >> 10), lo = 0xDC00 | (cp & 0x3FF);
+            out[len++] = hi & 0xFF;
+            out[len++] = hi >> 8;
+            out[len++] = lo & 0xFF;
+            out[len++] = lo >> 8;
+        }
+        else
+        {
+            if (len + 2 > out_len)
+                return 0;
+            out[len++] = cp & 0xFF;
+            out[len++] = cp >> 8;
+        }
+    }
+    return len;
+}
+
+static unsigned char pick_encoding(const char *value, unsigned char version)
+{
+    for (const unsigned char *s = (const unsigned char *)value; *s; s++)
+    {
+        if (*s >= 0x80)
+            return version >= 4 ? 3 : 1;
+    }
+    return 0;
+}
+
+static unsigned int encode_text(const char *value, unsigned char version, unsigned char *out, unsigned int out_len)
+{
+    if (out_len < 1)
+        return 0;
+
+    out[0] = pick_encoding(value, version);
+    unsigned int n = encode_string(value, version, out[0], out + 1, out_len - 1);
+    return (n || value[0] == '\0') ? n + 1 : 0;
+}
+
+static unsigned int encode_comment(const char *value, unsigned char version, unsigned char *out, unsigned int out_len)
+{
+    unsigned char encoding = pick_encoding(value, version);
+    unsigned int head = (encoding == 1) ? 6 : 5; // Encoding, "eng", empty description terminator
+    if (out_len < head)
+        return 0;
+
+    out[0] = encoding;
+    memcpy(out + 1, "eng", 3);
+    out[4] = 0;
+    if (encoding == 1)
+        out[5] = 0;
+
+    unsigned int n = encode_string(value, version, encoding, out + head, out_len - head);
+    return (n || value[0] == '\0') ? n + head : 0;
+}
+
+static unsigned int encode_url(const char *value, unsigned char version, unsigned char *out, unsigned int out_len)
+{
+    return encode_string(value, version, 0, out, out_len);
+}
@@ -0,0 +1,476 @@
+/*
+Documentation
+Name        : Vamsi T
+Date        : 30/7/25
+Description : MP3 Tag Reader project - fuzz entry points and worst-case parser benchmark
+*/
+
+/*
+ * AFL      : afl-fuzz -i seeds -o findings -- ./a.out --fuzz-one
+ * libFuzzer: clang -g -fsanitize=fuzzer-no-link,address -DMP3_TAG_LIBFUZZER *.c \
+ *                $(clang -print-file-name=libclang_rt.fuzzer_no_main-x86_64.a) -lstdc++
+ *            ./a.out --fuzz --libfuzzer corpus/
+ * Built-in : ./a.out --fuzz [--iterations N] [--seed S]
+ */
+
+#define _GNU_SOURCE
+#include "mp3_tag_reader.h"
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FUZZ_MAX_INPUT (1 << 20)         // Longer inputs are cut, like libFuzzer's -max_len
+#define FUZZ_TIME_PER_MB 0.25            // Seconds allowed per MiB of input, with 1 MiB minimum
+#define FUZZ_MEMORY_LIMIT_KB (16 * 1024) // Peak RSS growth allowed over the whole run
+#define FUZZ_ITERATIONS 20000
+
+static FILE *fuzz_report; // Results, stdout and stderr are silenced while parsers run
+
+// The rewriting walkers into a second memfd: the tag edit (copy_first_part, modify_tag, copy_frames and the
+// verified audio copy) or the front-cover drop of replace-art
+static void fuzz_rewrite(int fd, int art)
+{
+    TagOperationInfo tagopinfo = {0};
+    tagopinfo.filename = "<fuzz>";
+    tagopinfo.new_filename = "<fuzz output>";
+    tagopinfo.fptr_mp3 = fdopen(dup(fd), "rb");
+    int out = memfd_create("mp3-fuzz-out", MFD_CLOEXEC);
+    tagopinfo.fptr_new_mp3 = (out >= 0) ? fdopen(out, "w+b") : NULL;
+    if (tagopinfo.fptr_new_mp3 == NULL && out >= 0)
+        close(out);
+
+    // Both callers refuse v2.2 before walking
+    if (tagopinfo.fptr_mp3 != NULL && tagopinfo.fptr_new_mp3 != NULL && check_id_and_version(&tagopinfo) == success &&
+        tagopinfo.version >= 3)
+    {
+        if (art)
+        {
+            if (copy_id3_header(&tagopinfo) == success && copy_frames(&tagopinfo, "APIC", 3) == success)
+                copy_padding_and_audio(&tagopinfo);
+        }
+        else
+        {
+            tagopinfo.frame = lookup_edit_option('t', tagopinfo.version);
+            strcpy(tagopinfo.new_value, "fuzz");
+            tagopinfo.verify = 1;
+            edit_mp3_tag(&tagopinfo);
+        }
+    }
+
+    if (tagopinfo.fptr_mp3 != NULL)
+        fclose(tagopinfo.fptr_mp3);
+    if (tagopinfo.fptr_new_mp3 != NULL)
+        fclose(tagopinfo.fptr_new_mp3);
+}
+
+// Every parser over the same bytes: stream, scan, view, frame lookup, the APIC prefix, the edit and
+// replace-art walkers and normalize's conversion to both versions (dry run)
+Status fuzz_one_input(const unsigned char *data, size_t len)
+{
+    if (len > FUZZ_MAX_INPUT)
+        len = FUZZ_MAX_INPUT;
+
+    int fd = memfd_create("mp3-fuzz", MFD_CLOEXEC);
+    if (fd < 0 || write(fd, data, len) != (ssize_t)len)
+    {
+        if (fd >= 0)
+            close(fd);
+        return failure;
+    }
+
+    TagRecord record;
+    unsigned char consumed[10];
+    long consumed_len;
+    lseek(fd, 0, SEEK_SET);
+    stream_read_tags(fd, &record, consumed, &consumed_len);
+
+    // scan_file closes the descriptor it is given, the duration probe parses the MPEG/Xing headers too
+    off_t bytes = 0;
+    ScanEntry entry = {"<fuzz>", 0, dup(fd)};
+    lseek(fd, 0, SEEK_SET);
+    if (entry.fd >= 0)
+        scan_file(&entry, &record, &bytes, 1);
+
+    TagOperationInfo tagopinfo = {0};
+    tagopinfo.filename = "<fuzz>";
+    tagopinfo.fptr_mp3 = fdopen(dup(fd), "rb");
+    if (tagopinfo.fptr_mp3 != NULL)
+    {
+        off_t offset;
+        unsigned int size;
+        if (check_id_and_version(&tagopinfo) == success)
+        {
+            view_mp3_tags(&tagopinfo);
+            if (find_frame(&tagopinfo, "APIC", &offset, &size) == success &&
+                fseeko(tagopinfo.fptr_mp3, offset + 10, SEEK_SET) == 0)
+            {
+                char mime[MAX_MIME_LEN];
+                int picture_type;
+                read_apic_prefix(tagopinfo.fptr_mp3, size, mime, &picture_type);
+            }
+        }
+        fclose(tagopinfo.fptr_mp3);
+    }
+
+    fuzz_rewrite(fd, 0);
+    fuzz_rewrite(fd, 1);
+
+    // normalize_file opens by path
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+    normalize_check(path);
+
+    close(fd);
+    return success;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long peak_rss_kb(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static double time_budget(size_t len)
+{
+    double mib = len / (1024.0 * 1024.0);
+    return FUZZ_TIME_PER_MB * (mib < 1 ? 1 : mib);
+}
+
+// xorshift64, the same seed replays the same inputs
+static unsigned long long fuzz_rand(unsigned long long *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void put_synchsafe(unsigned char *p, unsigned int value)
+{
+    convert_int_to_synchsafe(value, p);
+}
+
+static size_t put_frame(unsigned char *p, const char *id, unsigned char version, const char *body, unsigned int size)
+{
+    memcpy(p, id, 4);
+    encode_frame_size(size, version, &p[4]);
+    p[8] = p[9] = 0;
+    memcpy(&p[10], body, size);
+    return 10 + size;
+}
+
+// A small well-formed tag, the starting point for truncation and mutation
+static size_t make_seed(unsigned char *buffer, unsigned char version)
+{
+    size_t len = 10;
+    memcpy(buffer, "ID3", 3);
+    buffer[3] = version;
+    buffer[4] = buffer[5] = 0;
+
+    if (version == 2)
+    {
+        const char frame[] = "TT2\0\0\6\0Title";
+        memcpy(&buffer[len], frame, 12);
+        len += 12;
+    }
+    else
+    {
+        len += put_frame(&buffer[len], "TIT2", version, "\0Title", 6);
+        len += put_frame(&buffer[len], "TPE1", version, "\1\xFF\xFE" "A\0r\0t\0", 9);
+        len += put_frame(&buffer[len], "COMM", version, "\0engdesc\0text", 13);
+        len += put_frame(&buffer[len], "TXXX", version, "\0key\0value", 10);
+        len += put_frame(&buffer[len], "APIC", version, "\0image/png\0\3\0\x89PNG", 16);
+    }
+    memset(&buffer[len], 0, 64); // Padding
+    len += 64;
+    put_synchsafe(&buffer[6], len - 10);
+
+    // Start of the audio: one MPEG-1 Layer III frame header with a Xing frame count
+    unsigned char audio[64] = {0xFF, 0xFB, 0x90, 0x00};
+    memcpy(&audio[36], "Xing\0\0\0\1\0\0\3\xE8", 12);
+    memcpy(&buffer[len], audio, sizeof(audio));
+    return len + sizeof(audio);
+}
+
+// Runs one input with its time budget, the peak RSS is checked once for the whole run
+static int run_case(const char *name, const unsigned char *data, size_t len, double *worst)
+{
+    double start = now_seconds();
+    fuzz_one_input(data, len);
+    double elapsed = now_seconds() - start;
+
+    if (elapsed > *worst)
+        *worst = elapsed;
+    if (elapsed > time_budget(len))
+    {
+        fprintf(fuzz_report, "❌ %s: %zu bytes took %.3f s (budget %.3f s)\n", name, len, elapsed, time_budget(len));
+        return 0;
+    }
+    return 1;
+}
+
+static int worst_case(const char *name, const unsigned char *data, size_t len)
+{
+    double worst = 0;
+    int ok = run_case(name, data, len, &worst);
+    if (ok)
+        fprintf(fuzz_report, "✅ %-28s: %8zu bytes %9.3f ms\n", name, len, worst * 1000);
+    return ok;
+}
+
+// Inputs built to hit the limits of every size field and loop
+static int run_worst_cases(unsigned char *buffer)
+{
+    int ok = 1;
+    size_t len;
+
+    // As many empty frames as fit in a MiB
+    len = 10;
+    memcpy(buffer, "ID3\4\0\0", 6);
+    while (len + 10 <= FUZZ_MAX_INPUT)
+        len += put_frame(&buffer[len], "TXXX", 4, "", 0);
+    put_synchsafe(&buffer[6], len - 10);
+    ok &= worst_case("Max frame count (v2.4)", buffer, len);
+
+    // Same for v2.2, 6-byte frame headers
+    len = 10;
+    memcpy(buffer, "ID3\2\0\0", 6);
+    while (len + 6 <= FUZZ_MAX_INPUT)
+    {
+        memcpy(&buffer[len], "TT2\0\0\0", 6);
+        len += 6;
+    }
+    put_synchsafe(&buffer[6], len - 10);
+    ok &= worst_case("Max frame count (v2.2)", buffer, len);
+
+    // Largest tag and frame sizes the headers can express, over 64 real bytes
+    memcpy(buffer, "ID3\4\0\0", 6);
+    put_synchsafe(&buffer[6], 0x0FFFFFFF);
+    memcpy(&buffer[10], "APIC", 4);
+    put_synchsafe(&buffer[14], 0x0FFFFFF0);
+    memset(&buffer[18], 0, 56);
+    ok &= worst_case("Max size claim (v2.4)", buffer, 74);
+
+    memcpy(buffer, "ID3\3\0\0", 6);
+    put_synchsafe(&buffer[6], 0x0FFFFFFF);
+    memcpy(&buffer[10], "TIT2\xFF\xFF\xFF\xFF\0\0", 10);
+    ok &= worst_case("Frame size 0xFFFFFFFF (v2.3)", buffer, 74);
+
+    memcpy(buffer, "ID3\4\0\x40", 6);
+    put_synchsafe(&buffer[6], 0x0FFFFFFF);
+    memcpy(&buffer[10], "\x7F\x7F\x7F\x7F", 4);
+    ok &= worst_case("Extended header size claim", buffer, 74);
+
+    // Zero-size frames of every kind the registry decodes
+    len = 10;
+    memcpy(buffer, "ID3\3\0\0", 6);
+    const char *ids[] = {"TIT2", "TXXX", "WXXX", "WOAR", "COMM", "APIC", "PRIV", "ZZZZ"};
+    for (int i = 0; i < 8; i++)
+        len += put_frame(&buffer[len], ids[i], 3, "", 0);
+    put_synchsafe(&buffer[6], len - 10);
+    ok &= worst_case("Zero-size frames", buffer, len);
+
+    // One MiB of noise behind a valid header
+    unsigned long long state = 0x9E3779B97F4A7C15ULL;
+    memcpy(buffer, "ID3\3\0\0", 6);
+    put_synchsafe(&buffer[6], FUZZ_MAX_INPUT - 10);
+    for (len = 10; len < FUZZ_MAX_INPUT; len++)
+        buffer[len] = 'A' + fuzz_rand(&state) % 26;
+    ok &= worst_case("Frame-like noise", buffer, len);
+
+    // Every truncation of every seed
+    for (unsigned char version = 2; version <= 4; version++)
+    {
+        unsigned char seed[1024];
+        size_t seed_len = make_seed(seed, version);
+        double worst = 0, start = now_seconds();
+        int cut_ok = 1;
+        for (size_t cut = 0; cut <= seed_len; cut++)
+            cut_ok &= run_case("Truncated tag", seed, cut, &worst);
+
+        fprintf(fuzz_report, "%s Truncated v2.%d at every byte : %8zu cuts  %9.3f ms total, %.3f ms worst\n",
+                cut_ok ? "✅" : "❌", version, seed_len + 1, (now_seconds() - start) * 1000, worst * 1000);
+        ok &= cut_ok;
+    }
+
+    return ok;
+}
+
+// Byte flips, size fields forced to extremes, truncation and splices of the seeds
+static int run_mutations(unsigned char *buffer, long iterations, unsigned long long seed)
+{
+    static const unsigned char extremes[] = {0x00, 0x01, 0x7F, 0x80, 0xFF};
+    unsigned char seeds[3][1024];
+    size_t seed_len[3];
+    for (int v = 0; v < 3; v++)
+        seed_len[v] = make_seed(seeds[v], v + 2);
+
+    unsigned long long state = seed ? seed : 1;
+    double worst = 0;
+    int ok = 1;
+
+    for (long i = 0; i < iterations; i++)
+    {
+        int v = fuzz_rand(&state) % 3;
+        size_t len = seed_len[v];
+        memcpy(buffer, seeds[v], len);
+
+        int mutations = 1 + fuzz_rand(&state) % 8;
+        for (int m = 0; m < mutations && len > 0; m++)
+        {
+            size_t pos = fuzz_rand(&state) % len;
+            switch (fuzz_rand(&state) % 4)
+            {
+            case 0:
+                buffer[pos] ^= 1 << (fuzz_rand(&state) % 8);
+                break;
+            case 1:
+                for (size_t k = pos; k < pos + 4 && k < len; k++)
+                    buffer[k] = extremes[fuzz_rand(&state) % sizeof(extremes)];
+                break;
+            case 2:
+                len = pos;
+                break;
+            default:
+            {
+                // Repeat a slice, makes runs of frames the seeds do not have
+                size_t n = fuzz_rand(&state) % 64;
+                if (len + n <= FUZZ_MAX_INPUT && pos + n <= len)
+                {
+                    memmove(&buffer[pos + n], &buffer[pos], len - pos);
+                    len += n;
+                }
+                break;
+            }
+            }
+        }
+
+        if (!run_case("Mutated input", buffer, len, &worst))
+        {
+            fprintf(fuzz_report, "   replay with --seed %llu, iteration %ld\n", seed, i);
+            ok = 0;
+        }
+    }
+
+    fprintf(fuzz_report, "%s %ld mutated inputs (seed %llu), worst %.3f ms\n", ok ? "✅" : "❌", iterations, seed, worst * 1000);
+    return ok;
+}
+
+#ifdef MP3_TAG_LIBFUZZER
+int LLVMFuzzerRunDriver(int *argc, char ***argv, int (*callback)(const uint8_t *data, size_t size));
+
+static int libfuzzer_callback(const uint8_t *data, size_t size)
+{
+    fuzz_one_input(data, size);
+    return 0;
+}
+#endif
+
+Status fuzz_stdin(void)
+{
+    unsigned char *buffer = malloc(FUZZ_MAX_INPUT);
+    if (buffer == NULL)
+        return failure;
+
+    size_t len = 0;
+    ssize_t n;
+    while (len < FUZZ_MAX_INPUT && (n = read(STDIN_FILENO, buffer + len, FUZZ_MAX_INPUT - len)) > 0)
+        len += n;
+
+    Status status = fuzz_one_input(buffer, len);
+    free(buffer);
+    return status;
+}
+
+Status fuzz(int argc, char *argv[])
+{
+    long iterations = FUZZ_ITERATIONS;
+    unsigned long long seed = (unsigned long long)time(NULL);
+
+    for (int i = 2; i < argc; i++)
+    {
+#ifdef MP3_TAG_LIBFUZZER
+        if (strcmp(argv[i], "--libfuzzer") == 0)
+        {
+            // libFuzzer takes over the rest of the command line. -close_fd_mask=3 sends the parsers' stdout and
+            // stderr to /dev/null while libFuzzer keeps its own output and sanitizer reports; a later flag wins.
+            char close_fds[] = "-close_fd_mask=3";
+            char **fuzz_argv = malloc((argc - i + 2) * sizeof(char *));
+            if (fuzz_argv == NULL)
+                return failure;
+            int fuzz_argc = 0;
+            fuzz_argv[fuzz_argc++] = argv[i];
+            fuzz_argv[fuzz_argc++] = close_fds;
+            for (int k = i + 1; k < argc; k++)
+                fuzz_argv[fuzz_argc++] = argv[k];
+            fuzz_argv[fuzz_argc] = NULL;
+
+            char **driver_argv = fuzz_argv;
+            int result = LLVMFuzzerRunDriver(&fuzz_argc, &driver_argv, libfuzzer_callback);
+            free(fuzz_argv);
+            return result == 0 ? success : failure;
+        }
+#endif
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = atol(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], NULL, 10);
+        else
+        {
+            fprintf(stderr, "❌ Error: Unknown fuzz option '%s'\n", argv[i]);
+            return failure;
+        }
+    }
+
+    unsigned char *buffer = malloc(FUZZ_MAX_INPUT + 64);
+    if (buffer == NULL)
+    {
+        fprintf(stderr, "❌ Memory allocation failed.\n");
+        return failure;
+    }
+
+    // The parsers print as they go, keep that out of the report
+    fflush(stdout);
+    fuzz_report = fdopen(dup(STDOUT_FILENO), "w");
+    int saved_err = dup(STDERR_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    if (fuzz_report == NULL || saved_err < 0 || devnull < 0)
+    {
+        free(buffer);
+        return failure;
+    }
+    setvbuf(fuzz_report, NULL, _IOLBF, 0);
+    dup2(devnull, STDOUT_FILENO);
+    dup2(devnull, STDERR_FILENO);
+
+    memset(buffer, 0, FUZZ_MAX_INPUT + 64);
+    long rss_before = peak_rss_kb();
+    fprintf(fuzz_report, "🧪 Worst-case inputs (budget %.2f s per MiB, %d KB peak memory growth)\n", FUZZ_TIME_PER_MB,
+            FUZZ_MEMORY_LIMIT_KB);
+    int ok = run_worst_cases(buffer);
+    ok &= run_mutations(buffer, iterations, seed);
+
+    long growth = peak_rss_kb() - rss_before;
+    int memory_ok = growth <= FUZZ_MEMORY_LIMIT_KB;
+    fprintf(fuzz_report, "%s Peak memory growth %ld KB\n", memory_ok ? "✅" : "❌", growth);
+
+    fflush(stdout);
+    dup2(saved_err, STDERR_FILENO);
+    dup2(fileno(fuzz_report), STDOUT_FILENO);
+    close(saved_err);
+    close(devnull);
+    fclose(fuzz_report);
+    free(buffer);
+    return (ok && memory_ok) ? success : failure;
+}
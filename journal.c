@@ -0,0 +1,237 @@
+/*
+Documentation
+Name        : Vamsi T
+Date        : 30/7/25
+Description : MP3 Tag Reader project - progress journal for resumable batch jobs
+*/
+
+#include "mp3_tag_reader.h"
+#include <errno.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define JOURNAL_SYNC_EVERY 256 // Records between fdatasync calls
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// FNV-1a
+static unsigned int hash_path(const char *path)
+{
+    unsigned int h = 2166136261u;
+    while (*path)
+    {
+        h ^= (unsigned char)*path++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static Status grow_table(BatchJournal *journal)
+{
+    int capacity = journal->capacity ? journal->capacity * 2 : 1024;
+    JournalEntry *entries = calloc(capacity, sizeof(JournalEntry));
+    if (entries == NULL)
+    {
+        fprintf(stderr, "❌ Memory allocation failed.\n");
+        return failure;
+    }
+
+    // Re-insert everything with open addressing
+    for (int i = 0; i < journal->capacity; i++)
+    {
+        if (journal->entries[i].path == NULL)
+            continue;
+        unsigned int slot = hash_path(journal->entries[i].path) & (capacity - 1);
+        while (entries[slot].path != NULL)
+            slot = (slot + 1) & (capacity - 1);
+        entries[slot] = journal->entries[i];
+    }
+
+    free(journal->entries);
+    journal->entries = entries;
+    journal->capacity = capacity;
+    return success;
+}
+
+static JournalEntry *find_entry(BatchJournal *journal, const char *path)
+{
+    if (journal->capacity == 0)
+        return NULL;
+
+    unsigned int slot = hash_path(path) & (journal->capacity - 1);
+    while (journal->entries[slot].path != NULL)
+    {
+        if (strcmp(journal->entries[slot].path, path) == 0)
+            return &journal->entries[slot];
+        slot = (slot + 1) & (journal->capacity - 1);
+    }
+    return NULL;
+}
+
+// Later lines win, so a file finished twice keeps its latest size/mtime
+static Status remember_entry(BatchJournal *journal, const char *path, long long size, long long mtime_ns)
+{
+    JournalEntry *entry = find_entry(journal, path);
+    if (entry == NULL)
+    {
+        if ((journal->count + 1) * 2 > journal->capacity && grow_table(journal) != success)
+            return failure;
+
+        unsigned int slot = hash_path(path) & (journal->capacity - 1);
+        while (journal->entries[slot].path != NULL)
+            slot = (slot + 1) & (journal->capacity - 1);
+        entry = &journal->entries[slot];
+        entry->path = strdup(path);
+        if (entry->path == NULL)
+        {
+            fprintf(stderr, "❌ Memory allocation failed.\n");
+            return failure;
+        }
+        journal->count++;
+    }
+
+    entry->size = size;
+    entry->mtime_ns = mtime_ns;
+    return success;
+}
+
+Status batch_journal_open(BatchJournal *journal, const char *path, int total)
+{
+    memset(journal, 0, sizeof(*journal));
+    journal->total = total;
+    journal->start = journal->last_report = now_seconds();
+
+    // No journal file: progress reporting only
+    if (path == NULL)
+        return success;
+
+    journal->fp = fopen(path, "a+");
+    if (journal->fp == NULL)
+    {
+        fprintf(stderr, "❌ Error: Unable to open journal '%s': %s\n", path, strerror(errno));
+        return failure;
+    }
+
+    // <size>\t<mtime in ns>\t<path>
+    char line[4200];
+    int torn = 0;
+    rewind(journal->fp);
+    while (fgets(line, sizeof(line), journal->fp) != NULL)
+    {
+        long long size, mtime_ns;
+        int path_start;
+        size_t len = strlen(line);
+        torn = (len == 0 || line[len - 1] != '\n');
+        if (torn)
+            continue; // Torn last line from an interrupted run
+        line[len - 1] = '\0';
+
+        if (sscanf(line, "%lld\t%lld\t%n", &size, &mtime_ns, &path_start) == 2 &&
+            remember_entry(journal, &line[path_start], size, mtime_ns) != success)
+            return failure;
+    }
+
+    // End the torn line, or the next record would be appended to it and lost on the following resume
+    fseeko(journal->fp, 0, SEEK_END);
+    if (torn && (fputc('\n', journal->fp) == EOF || fflush(journal->fp) != 0))
+    {
+        fprintf(stderr, "❌ Error: Unable to append to journal\n");
+        return failure;
+    }
+    fprintf(stderr, "📒 Journal '%s': %d file(s) already completed\n", path, journal->count);
+    return success;
+}
+
+static long long mtime_of(const struct stat *st)
+{
+    return (long long)st->st_mtim.tv_sec * 1000000000LL + st->st_mtim.tv_nsec;
+}
+
+int batch_is_done(BatchJournal *journal, const char *path)
+{
+    JournalEntry *entry = find_entry(journal, path);
+    if (entry == NULL)
+        return 0;
+
+    // Changed since it was journaled: do it again
+    struct stat st;
+    if (stat(path, &st) != 0 || st.st_size != entry->size || mtime_of(&st) != entry->mtime_ns)
+        return 0;
+
+    journal->skipped++;
+    return 1;
+}
+
+Status batch_mark_done(BatchJournal *journal, const char *path)
+{
+    journal->done++;
+    batch_progress(journal, 0);
+
+    if (journal->fp == NULL || strchr(path, '\n') != NULL)
+        return success;
+
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return failure;
+
+    if (fprintf(journal->fp, "%lld\t%lld\t%s\n", (long long)st.st_size, mtime_of(&st), path) < 0 || fflush(journal->fp) != 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to append to journal\n");
+        return failure;
+    }
+
+    if (++journal->unsynced >= JOURNAL_SYNC_EVERY)
+    {
+        fdatasync(fileno(journal->fp));
+        journal->unsynced = 0;
+    }
+    return success;
+}
+
+void batch_mark_failed(BatchJournal *journal)
+{
+    journal->failed++;
+    batch_progress(journal, 0);
+}
+
+void batch_progress(BatchJournal *journal, int final)
+{
+    double now = now_seconds();
+
+    // At most once a second, progress goes to stderr so records on stdout stay clean
+    if (!final && now - journal->last_report < 1.0)
+        return;
+    journal->last_report = now;
+
+    int finished = journal->done + journal->failed;
+    int remaining = journal->total - journal->skipped - finished;
+    double elapsed = now - journal->start;
+    double rate = elapsed > 0 ? finished / elapsed : 0;
+    long eta = (rate > 0 && remaining > 0) ? (long)(remaining / rate) : 0;
+
+    fprintf(stderr, "⏳ %d/%d done (%d skipped, %d failed) %.1f files/s ETA %ldh%02ldm%02lds%s",
+            finished + journal->skipped, journal->total, journal->skipped, journal->failed, rate,
+            eta / 3600, eta / 60 % 60, eta % 60, final ? "\n" : "\r");
+}
+
+void batch_journal_close(BatchJournal *journal)
+{
+    batch_progress(journal, 1);
+
+    if (journal->fp != NULL)
+    {
+        fdatasync(fileno(journal->fp));
+        fclose(journal->fp);
+    }
+
+    for (int i = 0; i < journal->capacity; i++)
+        free(journal->entries[i].path);
+    free(journal->entries);
+    memset(journal, 0, sizeof(*journal));
+}
@@ -0,0 +1,243 @@
+/*
+Documentation
+Name        : Vamsi T
+Date        : 30/7/25
+Description : MP3 Tag Reader project - large-file self-test on sparse fixtures, past 4 GiB and with a v2.4 footer
+*/
+
+#define _GNU_SOURCE
+#include "mp3_tag_reader.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LARGE_TAIL_OFFSET (4LL << 30)                          // Audio past here is checksummed around the edit
+#define LARGE_AUDIO_SIZE (LARGE_TAIL_OFFSET + (1 << 20) + 4093) // Not block aligned, holes cost no disk space
+#define LARGE_PADDING 2 // Less than the title edit adds, so the tag grows and the audio moves
+#define LARGE_PATTERN_SIZE (64 << 10)
+
+typedef struct
+{
+    const char *name;
+    unsigned char version;
+    unsigned char flags; // 0x40 extended header, 0x10 footer
+    long long audio_size;
+} LargeFixture;
+
+static const LargeFixture large_fixtures[] = {
+    {"ID3v2.4 with extended header and footer", 4, 0x50, (64 << 10) + 13},
+    {"ID3v2.3 past 4 GiB", 3, 0x00, LARGE_AUDIO_SIZE},
+};
+
+// Text frame with an ISO-8859-1 value
+static int put_text_frame(unsigned char *out, const char *id, const char *text, unsigned char version)
+{
+    unsigned int len = strlen(text) + 1;
+    memcpy(out, id, 4);
+    encode_frame_size(len, version, &out[4]);
+    out[8] = out[9] = 0;
+    out[10] = 0;
+    memcpy(&out[11], text, len - 1);
+    return 10 + len;
+}
+
+// Tag with a title and padding, audio markers at both ends, a hole in between and a block of noise where
+// the tail checksum starts
+static Status write_fixture(int fd, const LargeFixture *fixture, off_t *audio_offset)
+{
+    static unsigned char pattern[LARGE_PATTERN_SIZE];
+    unsigned int state = 0x9E3779B9;
+    for (int i = 0; i < LARGE_PATTERN_SIZE; i++)
+    {
+        state = state * 1103515245 + 12345;
+        pattern[i] = state >> 24;
+    }
+
+    unsigned char tag[10 + 16 + 2 * 64 + LARGE_PADDING + 10] = {0};
+    int len = 10;
+
+    // Extended header with the CRC flag clear: 6 bytes in v2.4 (size counts itself), 10 in v2.3
+    if (fixture->flags & 0x40)
+    {
+        if (fixture->version >= 4)
+        {
+            convert_int_to_synchsafe(6, &tag[len]);
+            tag[len + 4] = 1;
+            len += 6;
+        }
+        else
+        {
+            convert_int_to_big_endian(6, &tag[len]);
+            len += 10;
+        }
+    }
+    len += put_text_frame(&tag[len], "TIT2", "Large", fixture->version);
+    len += put_text_frame(&tag[len], "TPE1", "Check", fixture->version);
+    len += LARGE_PADDING;
+
+    memcpy(tag, "ID3", 3);
+    tag[3] = fixture->version;
+    tag[5] = fixture->flags;
+    convert_int_to_synchsafe(len - 10, &tag[6]);
+
+    // The footer repeats the header with "3DI"
+    if (fixture->flags & 0x10)
+    {
+        memcpy(&tag[len], tag, 10);
+        memcpy(&tag[len], "3DI", 3);
+        len += 10;
+    }
+    *audio_offset = len;
+
+    off_t pattern_at = len + ((fixture->audio_size > LARGE_TAIL_OFFSET) ? LARGE_TAIL_OFFSET : 4);
+    if (pwrite(fd, tag, len, 0) != len || pwrite(fd, "HEAD", 4, len) != 4 ||
+        pwrite(fd, pattern, LARGE_PATTERN_SIZE, pattern_at) != LARGE_PATTERN_SIZE ||
+        pwrite(fd, "TAIL", 4, len + fixture->audio_size - 4) != 4)
+    {
+        perror("❌ Error writing the fixture");
+        return failure;
+    }
+    return success;
+}
+
+// Checksum of the audio from LARGE_TAIL_OFFSET (or all of it when shorter) to the end of the file
+static Status tail_checksum(int fd, off_t audio_offset, off_t end, unsigned long long *hash)
+{
+    static unsigned char buffer[1 << 16];
+    off_t pos = audio_offset + ((end - audio_offset > LARGE_TAIL_OFFSET) ? LARGE_TAIL_OFFSET : 0);
+
+    *hash = CHECKSUM_INIT;
+    while (pos < end)
+    {
+        ssize_t n = pread(fd, buffer, sizeof(buffer), pos);
+        if (n <= 0)
+            return failure;
+        *hash = checksum_update(*hash, buffer, n);
+        pos += n;
+    }
+    return success;
+}
+
+// Reads the tag like --stream and checks the title, the audio start marker and the audio length
+static Status check_stream(const char *path, const char *title, long long audio_size, const char *what,
+                           unsigned long long *tail_hash)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        perror("❌ Error opening the fixture");
+        return failure;
+    }
+
+    TagRecord record;
+    unsigned char consumed[10];
+    long consumed_len;
+    char head[4] = {0}, tail[4] = {0};
+    struct stat st;
+    Status status = stream_read_tags(fd, &record, consumed, &consumed_len);
+    off_t audio_offset = lseek(fd, 0, SEEK_CUR);
+
+    // A footer must repeat the header, readers that start from the end of the tag trust its size
+    unsigned char footer[10];
+    if (status == success && record.version >= 4 && (consumed[5] & 0x10) &&
+        (pread(fd, footer, 10, audio_offset - 10) != 10 || memcmp(footer, "3DI", 3) != 0 ||
+         memcmp(&footer[3], &consumed[3], 7) != 0))
+    {
+        fprintf(stderr, "❌ %s: footer does not match the ID3v2 header\n", what);
+        close(fd);
+        return failure;
+    }
+
+    if (status == success && fstat(fd, &st) == 0 && pread(fd, head, 4, audio_offset) == 4 &&
+        pread(fd, tail, 4, st.st_size - 4) == 4 && strcmp(record.value[FIELD_TITLE], title) == 0 &&
+        memcmp(head, "HEAD", 4) == 0 && memcmp(tail, "TAIL", 4) == 0 && st.st_size - audio_offset == audio_size &&
+        tail_checksum(fd, audio_offset, st.st_size, tail_hash) == success)
+    {
+        printf("✅ %s: title \"%s\", %lld bytes of audio from offset %lld, %lld KB allocated, tail checksum %016llx\n",
+               what, record.value[FIELD_TITLE], (long long)(st.st_size - audio_offset), (long long)audio_offset,
+               (long long)st.st_blocks / 2, *tail_hash);
+    }
+    else
+    {
+        fprintf(stderr, "❌ %s: expected title \"%s\" and %lld bytes of audio between the markers\n", what, title,
+                audio_size);
+        status = failure;
+    }
+
+    close(fd);
+    return status;
+}
+
+// View, stream, edit and stream again one fixture in <dir>, the fixture is removed afterwards
+static Status check_fixture(const char *dir, char *argv0, const LargeFixture *fixture)
+{
+    char path[4096];
+    if (snprintf(path, sizeof(path), "%s/large-check-XXXXXX.mp3", dir) >= (int)sizeof(path))
+    {
+        fprintf(stderr, "❌ Error: Directory path too long\n");
+        return failure;
+    }
+
+    int fd = mkstemps(path, 4);
+    if (fd < 0)
+    {
+        perror("❌ Error creating the fixture");
+        return failure;
+    }
+
+    off_t audio_offset;
+    Status status = write_fixture(fd, fixture, &audio_offset);
+    close(fd);
+    printf("🧪 %s, sparse fixture %s: %lld bytes of audio after a %lld byte tag\n\n", fixture->name, path,
+           fixture->audio_size, (long long)audio_offset);
+
+    // View walks the frames with 64-bit seeks
+    char *view_argv[] = {argv0, "-v", path, NULL};
+    TagOperationInfo tagopinfo = {0};
+    if (status == success)
+    {
+        status = (read_and_validate_view_args(view_argv, &tagopinfo) == success) ? view(&tagopinfo) : failure;
+        close_files(&tagopinfo);
+        printf("%s View of the fixture\n\n", status == success ? "✅" : "❌");
+    }
+
+    unsigned long long before = 0, after = 0;
+    if (status == success)
+        status = check_stream(path, "Large", fixture->audio_size, "Stream before edit", &before);
+
+    // The edit grows the title past the padding, so the audio is moved with --verify
+    char *edit_argv[] = {argv0, "-e", "-t", "Large file edit", path, NULL};
+    memset(&tagopinfo, 0, sizeof(tagopinfo));
+    if (status == success)
+    {
+        tagopinfo.verify = 1;
+        status = (read_and_validate_edit_args(edit_argv, &tagopinfo) == success) ? edit(&tagopinfo) : failure;
+        close_files(&tagopinfo);
+        printf("\n%s Edit of the fixture\n", status == success ? "✅" : "❌");
+    }
+
+    if (status == success)
+        status = check_stream(path, "Large file edit", fixture->audio_size, "Stream after edit", &after);
+    if (status == success && before != after)
+    {
+        fprintf(stderr, "❌ Tail checksum changed by the edit (%016llx, now %016llx)\n", before, after);
+        status = failure;
+    }
+
+    remove(path);
+    return status;
+}
+
+Status large_file_check(int argc, char *argv[])
+{
+    const char *dir = (argc > 2) ? argv[2] : ".";
+    Status status = success;
+
+    for (size_t i = 0; i < sizeof(large_fixtures) / sizeof(large_fixtures[0]); i++)
+    {
+        if (check_fixture(dir, argv[0], &large_fixtures[i]) != success)
+            status = failure;
+        printf("\n");
+    }
+    return status;
+}
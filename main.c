@@ -20,14 +20,18 @@ int main(int argc, char *argv[])
         print_usage(); // 📘 Show usage instructions
         return 0;
     }
-    if (argc > 5)
+
+    tagopinfo.op_type = check_operation_type(argv);
+
+    // Optional --verify after the edit arguments
+    tagopinfo.verify = (tagopinfo.op_type == OP_EDIT && argc == 6 && strcmp(argv[5], "--verify") == 0);
+    if (argc > 5 + tagopinfo.verify && (tagopinfo.op_type == OP_VIEW || tagopinfo.op_type == OP_EDIT))
     {
         printf("⚠️  Warning: Tag content may contain spaces. Enclose it in quotes\n");
         printf("📥 Example: ./a.out -e -t \"Vamsi Thummaluri\" sample.mp3\n");
         return 0;
     }
 
-    tagopinfo.op_type = check_operation_type(argv);
     // 🆘 Handle --help operation
     if (tagopinfo.op_type == OP_HELP)
     {
@@ -94,6 +98,124 @@ int main(int argc, char *argv[])
         }
     }
 
+    // 🖼️ Cover art operations, any number of MP3 files
+    else if (tagopinfo.op_type == OP_EXTRACT_ART || tagopinfo.op_type == OP_REPLACE_ART)
+    {
+        // Optional --journal <file> to resume an interrupted batch
+        const char *journal_path = NULL;
+        int first = 2;
+        if (argc > 3 && strcmp(argv[2], "--journal") == 0)
+        {
+            journal_path = argv[3];
+            first = 4;
+        }
+
+        if (argc < first + 2)
+        {
+            print_usage();
+            return 0;
+        }
+
+        Status status = (tagopinfo.op_type == OP_EXTRACT_ART)
+                            ? extract_art(argv[first], argc - first - 1, &argv[first + 1], journal_path)
+                            : replace_art(argv[first], argc - first - 1, &argv[first + 1], journal_path);
+        if (status == success)
+            printf("\n✅ Cover art operation completed successfully!\n");
+        else
+            fprintf(stderr, "\n❌ Error: Cover art operation failed for one or more files\n");
+    }
+
+    // 🌊 Streaming reader on stdin, stdout stays clean for --pass
+    else if (tagopinfo.op_type == OP_STREAM)
+    {
+        if (stream(argc, argv) != success)
+            fprintf(stderr, "❌ Error: Failed to read tags from the input stream\n");
+    }
+
+    // 📚 Library scan, one record per file on stdout
+    else if (tagopinfo.op_type == OP_SCAN)
+    {
+        if (argc < 3)
+        {
+            print_usage();
+            return 0;
+        }
+
+        if (scan(argc, argv) != success)
+            fprintf(stderr, "❌ Error: Scan failed for one or more files\n");
+    }
+
+    // 👀 Watch mode, changed records on stdout until Ctrl+C
+    else if (tagopinfo.op_type == OP_WATCH)
+    {
+        if (argc < 3)
+        {
+            print_usage();
+            return 0;
+        }
+
+        if (watch(argc, argv) != success)
+            fprintf(stderr, "❌ Error: Watch mode failed\n");
+    }
+
+    // 📦 Columnar export of the whole library
+    else if (tagopinfo.op_type == OP_EXPORT)
+    {
+        if (argc < 4)
+        {
+            print_usage();
+            return 0;
+        }
+
+        if (export_columns(argc, argv) == success)
+            printf("\n✅ Export completed successfully!\n");
+        else
+            fprintf(stderr, "\n❌ Error: Export failed or left files out\n");
+    }
+
+    // 🧹 Bulk normalize, one rewrite per file
+    else if (tagopinfo.op_type == OP_NORMALIZE)
+    {
+        if (argc < 3)
+        {
+            print_usage();
+            return 0;
+        }
+
+        if (normalize(argc, argv) == success)
+            printf("\n✅ Normalize completed successfully!\n");
+        else
+            fprintf(stderr, "\n❌ Error: Normalize failed for one or more files\n");
+    }
+
+    // 🧪 Parser fuzzing and worst-case benchmark
+    else if (tagopinfo.op_type == OP_FUZZ)
+    {
+        if (fuzz(argc, argv) == success)
+            printf("\n✅ Parsers stayed within their time and memory budgets\n");
+        else
+        {
+            fprintf(stderr, "\n❌ Error: Parser budget exceeded\n");
+            return 1;
+        }
+    }
+
+    // One input on stdin, for AFL
+    else if (tagopinfo.op_type == OP_FUZZ_ONE)
+        fuzz_stdin();
+
+    // 🗄️ Edit, view and stream of a sparse fixture past 4 GiB
+    else if (tagopinfo.op_type == OP_LARGE_FILE_CHECK)
+    {
+        if (large_file_check(argc, argv) == success)
+            printf("\n✅ Large-file check passed\n");
+        else
+        {
+            fprintf(stderr, "\n❌ Error: Large-file check failed\n");
+            return 1;
+        }
+    }
+
     // ⚠️ Invalid operation
     else
     {
@@ -110,7 +232,16 @@ void print_usage()
     printf("❌ ERROR: ./a.out : INVALID ARGUMENTS\n\n");
     printf("📌 USAGE GUIDE:\n");
     printf("   To view please pass like    : ./a.out -v <mp3filename>\n");
-    printf("   To edit please pass like    : ./a.out -e -t/-a/-A/-m/-y/-c <changing text> <mp3filename>\n");
+    printf("   To edit please pass like    : ./a.out -e -t/-a/-A/-m/-y/-c <changing text> <mp3filename> [--verify]\n");
+    printf("   To extract cover art        : ./a.out --extract-art [--journal <file>] <output dir> <mp3filename>...\n");
+    printf("   To replace cover art        : ./a.out --replace-art [--journal <file>] <image file> <mp3filename>...\n");
+    printf("   To read tags from a pipe    : ./a.out --stream [--pass] < <mp3filename>\n");
+    printf("   To scan a music library     : ./a.out --scan [--bench] [--journal <file>] [--workers N [--shard dir|size]] <directory/mp3filename>...\n");
+    printf("   To watch a music library    : ./a.out --watch [--index <file>] <directory>...\n");
+    printf("   To export a library         : ./a.out --export <output file> [--threads N] <directory/mp3filename>...\n");
+    printf("   To normalize a library      : ./a.out --normalize [--to 3|4] [--padding N] [--strip-v1] [--align] [--dry-run] [--threads N] [--journal <file>] <directory/mp3filename>...\n");
+    printf("   To fuzz the tag parsers     : ./a.out --fuzz [--iterations N] [--seed S]  or  ./a.out --fuzz-one < input\n");
+    printf("   To check files past 4 GiB   : ./a.out --large-file-check [directory]\n");
     printf("   To get help pass like       : ./a.out --help\n");
     // printf("\n💡 Tip: Use double quotes for values with spaces!\n");
     printf("\n-----------------------------------------------------------------------------------------------\n");
@@ -125,7 +256,22 @@ void print_help()
 
     printf("\n🧭 USAGE:\n");
     printf("  🔍 View tags : ./a.out -v <mp3_filename>\n");
-    printf("  ✏️  Edit tags : ./a.out -e <option> <changing text> <mp3_filename>\n");
+    printf("  ✏️  Edit tags : ./a.out -e <option> <changing text> <mp3_filename> [--verify]  (--verify checksums the audio copy)\n");
+    printf("  🖼️  Extract art: ./a.out --extract-art [--journal <file>] <output_dir> <mp3_filename>...\n");
+    printf("  🖼️  Replace art: ./a.out --replace-art [--journal <file>] <image_file> <mp3_filename>...  (front cover only)\n");
+    printf("  🌊 Stream     : ./a.out --stream [--pass]  (reads stdin, --pass writes the audio to stdout)\n");
+    printf("  📚 Scan       : ./a.out --scan [--bench] [--journal <file>] [--workers N [--shard dir|size]] <directory_or_mp3>...\n");
+    printf("                 (--bench compares cold-cache orders, --workers merges N worker processes in path order)\n");
+    printf("  👀 Watch      : ./a.out --watch [--index <file>] <directory>...  (U/D lines on stdout as tags change)\n");
+    printf("                 (--index keeps a snapshot in <file> and the U/D changes since then in <file>.log,\n"
+           "                  a restart re-parses only files whose size or mtime changed)\n");
+    printf("  📦 Export     : ./a.out --export <output_file> [--threads N] <directory_or_mp3>...  (dictionary-encoded columns)\n");
+    printf("  🧹 Normalize  : ./a.out --normalize [--to 3|4] [--padding N] [--strip-v1] [--align] [--dry-run] [--threads N] [--journal <file>] <directory_or_mp3>...\n");
+    printf("                 (dedupes frames, converts the version, right-sizes padding, --align keeps the audio reflinkable)\n");
+    printf("  🧪 Fuzz       : ./a.out --fuzz [--iterations N] [--seed S]  (worst-case inputs and mutations, time/memory budgets)\n");
+    printf("                 ./a.out --fuzz-one < input  (one input from stdin, for afl-fuzz)\n");
+    printf("  🗄️ Large file : ./a.out --large-file-check [directory]  (verified edit, view and stream of a sparse fixture past 4 GiB)\n");
+    printf("  📒 --journal  : Records finished files, a re-run skips them (append the output with >>)\n");
     printf("  🆘 Help       : ./a.out --help\n");
 
     printf("\n🎯 TAG OPTIONS FOR EDITING:\n");
@@ -139,6 +285,15 @@ void print_help()
     printf("\n📂 EXAMPLES:\n");
     printf("  ./a.out -v mysong.mp3\n");
     printf("  ./a.out -e -t \"New Content\" song.mp3\n");
+    printf("  ./a.out -e -a \"New Artist\" song.mp3 --verify\n");
+    printf("  ./a.out --scan ~/Music > library.tsv\n");
+    printf("  ./a.out --scan --workers 8 --shard size /archive > archive.tsv\n");
+    printf("  ./a.out --watch --index library.tsv ~/Music\n");
+    printf("  ./a.out --export library.cols --threads 8 ~/Music\n");
+    printf("  ./a.out --normalize --to 4 --strip-v1 --dry-run ~/Music\n");
+    printf("  fetch song.mp3 | ./a.out --stream --pass | player -\n");
+    printf("  ./a.out --extract-art covers/ song1.mp3 song2.mp3\n");
+    printf("  ./a.out --replace-art cover.jpg song1.mp3 song2.mp3\n");
 
     printf("═══════════════════════════════════════════════════════════════════════════════════\n");
 }
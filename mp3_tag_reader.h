@@ -1,10 +1,14 @@
 #ifndef MP3_TAG_READER_H
 #define MP3_TAG_READER_H
 
+// 64-bit off_t, fseeko/ftello and pread/pwrite offsets on 32-bit builds too
+#define _FILE_OFFSET_BITS 64
+
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/types.h>
 
 typedef enum
 {
@@ -17,6 +21,16 @@ typedef enum
     OP_HELP,
     OP_VIEW,
     OP_EDIT,
+    OP_EXTRACT_ART,
+    OP_REPLACE_ART,
+    OP_STREAM,
+    OP_SCAN,
+    OP_WATCH,
+    OP_EXPORT,
+    OP_NORMALIZE,
+    OP_FUZZ,
+    OP_FUZZ_ONE,
+    OP_LARGE_FILE_CHECK,
     OP_INVALID
 } OperationType;
 
@@ -32,11 +46,105 @@ typedef struct
     unsigned char genre; // Genre byte
 } ID3Tag;
 
+// ID3v2 versions a frame ID belongs to
+#define ID3_V22 0x01
+#define ID3_V23 0x02
+#define ID3_V24 0x04
+
+typedef enum
+{
+    FRAME_TEXT,      // T000 - TZZZ
+    FRAME_USER_TEXT, // TXXX
+    FRAME_URL,       // W000 - WZZZ
+    FRAME_USER_URL,  // WXXX
+    FRAME_COMMENT,   // COMM, USLT
+    FRAME_PICTURE,   // APIC, PIC
+    FRAME_BINARY     // Everything else
+} FrameType;
+
+// Columns of a TagRecord
+typedef enum
+{
+    FIELD_NONE = -1,
+    FIELD_TITLE,
+    FIELD_ARTIST,
+    FIELD_ALBUM,
+    FIELD_YEAR,
+    FIELD_GENRE,
+    FIELD_COMMENT
+} RecordField;
+
+// One entry of the frame registry (frames.c)
+typedef struct
+{
+    char id[5];               // 4 characters, 3 for ID3v2.2
+    unsigned char versions;   // ID3_V22 | ID3_V23 | ID3_V24
+    FrameType type;
+    RecordField field;        // Column in TagRecord, FIELD_NONE if not collected
+    char option;              // Edit option letter (-t, -a ...), 0 if not editable
+    const char *description;
+} FrameInfo;
+
+typedef void (*FrameDecoder)(const FrameInfo *info, const unsigned char *data, unsigned int size, char *out, int out_len);
+typedef unsigned int (*FrameEncoder)(const char *value, unsigned char version, unsigned char *out, unsigned int out_len);
+
+// Tag values collected for one file, in RecordField order
+#define RECORD_FIELDS 6
+#define RECORD_VALUE_LEN 256
+#define VIEW_FRAME_LIMIT 4096 // Bytes of a frame read for display or a record
+typedef struct
+{
+    unsigned char version; // 0 when the input has no ID3v2 tag
+    char value[RECORD_FIELDS][RECORD_VALUE_LEN];
+    unsigned int duration_ms; // Filled by scan_file when asked for, 0 when unknown
+} TagRecord;
+
+// One file of a library scan
+#define SCAN_LOOKAHEAD 16 // Files opened and hinted ahead of the parser
+typedef struct
+{
+    char *path;
+    unsigned long long location; // Physical offset of the first extent, or the inode number
+    int fd;                      // Opened ahead of the parser for readahead, -1 otherwise
+} ScanEntry;
+
+typedef struct
+{
+    ScanEntry *entries;
+    int count;
+    int capacity;
+} ScanList;
+
+// Completed file in a batch journal
+typedef struct
+{
+    char *path;
+    long long size;
+    long long mtime_ns;
+} JournalEntry;
+
+// Progress of a batch job and the journal of files already done
+typedef struct
+{
+    FILE *fp;              // Append-only journal, NULL for progress reporting only
+    JournalEntry *entries; // Open-addressing table keyed by path
+    int capacity;
+    int count;
+    int unsynced;
+
+    int total;
+    int done;
+    int skipped;
+    int failed;
+    double start;
+    double last_report;
+} BatchJournal;
+
 // Holds user inputs and operational data
 typedef struct
 {
     OperationType op_type;
-    int tag_index;
+    const FrameInfo *frame; // Frame selected by the edit option
     char new_value[50];
 
     // original file name
@@ -46,6 +154,14 @@ typedef struct
     // new file name
     char *new_filename; // MP3 file name
     FILE *fptr_new_mp3;
+    char new_path[4096]; // Storage for new_filename (same directory as the original)
+
+    // ID3v2 header details
+    unsigned char version;  // Major version (3 or 4)
+    unsigned char flags;    // Header flags
+    unsigned int tag_size;  // Tag size from the header (excludes the 10-byte header)
+
+    int verify; // Hash the audio of the source and the result while copying (--verify)
 } TagOperationInfo;
 
 // Utility
@@ -55,12 +171,13 @@ void print_help();
 // Validation & Argument Handling
 OperationType check_operation_type(char *argv[]);
 Status read_and_validate_view_args(char *argv[], TagOperationInfo *tagopinfo);
+int is_mp3_filename(const char *filename);
 
 // View Operation
 Status check_id_and_version(TagOperationInfo *tagopinfo);
 Status view_mp3_tags(TagOperationInfo *tagopinfo);
 Status view(TagOperationInfo *tagopinfo);
-void compare_view_tags(char tag[], int size, char cont[]);
+void compare_view_tags(char tag[], unsigned int size, unsigned char cont[]);
 unsigned int convert_big_endian_to_little_endian(unsigned char *bytes);
 void print(const char *cont, int size);
 
@@ -71,9 +188,17 @@ Status read_and_validate_edit_args(char *argv[], TagOperationInfo *tagopinfo);
 Status edit(TagOperationInfo *tagopinfo);
 void compare_edit_tags(char tag[], int size, char cont[], TagOperationInfo *tagopinfo);
 void convert_int_to_big_endian(unsigned int value, unsigned char *bytes);
+void convert_int_to_synchsafe(unsigned int value, unsigned char *bytes);
+unsigned int decode_frame_size(unsigned char *bytes, unsigned char version);
+Status check_frame_fits(off_t offset, unsigned int size, off_t end);
+off_t id3_audio_offset(unsigned char version, unsigned char flags, unsigned int tag_size);
+Status copy_id3_header(TagOperationInfo *tagopinfo);
 Status copy_first_part(TagOperationInfo *tagopinfo);
 Status modify_tag(TagOperationInfo *tagopinfo);
 Status copy_remaining(TagOperationInfo *tagopinfo);
+Status copy_frames(TagOperationInfo *tagopinfo, const char *skip_id, int skip_picture_type);
+Status copy_padding_and_audio(TagOperationInfo *tagopinfo);
+void encode_frame_size(unsigned int value, unsigned char version, unsigned char *bytes);
 
 // File I/O
 Status open_mp3_file_view(TagOperationInfo *tagopinfo);
@@ -82,4 +207,70 @@ Status rename_mp3_file(TagOperationInfo *tagopinfo);
 void close_files(TagOperationInfo *tagopinfo);
 Status read_id3_tag(FILE *fp, ID3Tag *tag);
 
+// Frame Registry
+const FrameInfo *lookup_frame(const unsigned char *id, int id_len);
+const FrameInfo *lookup_edit_option(char option, unsigned char version);
+FrameDecoder frame_decoder(const FrameInfo *info);
+FrameEncoder frame_encoder(const FrameInfo *info);
+
+// Reflink / Fast Copy
+Status copy_audio_region(int src_fd, off_t src_offset, int dst_fd, off_t dst_offset);
+Status copy_fd_range(int src_fd, off_t src_offset, int dst_fd, off_t dst_offset, off_t length);
+long reflink_block_size(int fd);
+Status copy_audio_verified(int src_fd, off_t src_offset, int dst_fd, off_t dst_offset);
+#define CHECKSUM_INIT 14695981039346656037ULL
+unsigned long long checksum_update(unsigned long long hash, const unsigned char *data, size_t len);
+
+// Cover Art (APIC)
+#define MAX_MIME_LEN 64
+Status find_frame(TagOperationInfo *tagopinfo, const char *id, off_t *frame_offset, unsigned int *size);
+Status extract_art(const char *out_dir, int count, char *files[], const char *journal_path);
+Status replace_art(const char *image, int count, char *files[], const char *journal_path);
+Status extract_art_file(const char *out_dir, char *filename);
+Status replace_art_file(const char *image, char *filename);
+long read_apic_prefix(FILE *fp, unsigned int size, char mime[], int *picture_type);
+
+// Streaming Reader (pipes / stdin)
+Status stream(int argc, char *argv[]);
+Status stream_read_tags(int fd, TagRecord *record, unsigned char *consumed, long *consumed_len);
+int format_record(char *out, size_t out_len, const char *path, const TagRecord *record);
+void print_record(FILE *out, const char *path, const TagRecord *record);
+
+// Library Scan
+Status scan(int argc, char *argv[]);
+Status collect_mp3_files(const char *path, ScanList *list);
+void sort_by_disk_location(ScanList *list);
+void prefetch_entry(ScanEntry *entry);
+Status scan_file(ScanEntry *entry, TagRecord *record, off_t *bytes_read, int with_duration);
+Status scan_list(ScanList *list, int print_records, off_t *bytes_read, BatchJournal *journal);
+void free_scan_list(ScanList *list);
+Status scan_sharded(ScanList *list, int workers, int by_size, BatchJournal *journal);
+
+// Watch Mode (incremental re-index)
+Status watch(int argc, char *argv[]);
+
+// Columnar Export
+Status export_columns(int argc, char *argv[]);
+unsigned int audio_duration_ms(int fd, off_t audio_offset);
+
+// Bulk Normalize
+Status normalize(int argc, char *argv[]);
+Status normalize_check(const char *path);
+
+// Fuzzing / Worst-case Parser Benchmark
+Status fuzz(int argc, char *argv[]);
+Status fuzz_stdin(void);
+Status fuzz_one_input(const unsigned char *data, size_t len);
+
+// Large-file Self-test (sparse fixture past 4 GiB)
+Status large_file_check(int argc, char *argv[]);
+
+// Batch Journal / Progress
+Status batch_journal_open(BatchJournal *journal, const char *path, int total);
+int batch_is_done(BatchJournal *journal, const char *path);
+Status batch_mark_done(BatchJournal *journal, const char *path);
+void batch_mark_failed(BatchJournal *journal);
+void batch_progress(BatchJournal *journal, int final);
+void batch_journal_close(BatchJournal *journal);
+
 #endif // MP3_TAG_READER_H
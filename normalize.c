@@ -0,0 +1,801 @@
+/*
+Documentation
+Name        : Vamsi T
+Date        : 30/7/25
+Description : MP3 Tag Reader project - bulk tag normalization (dedupe, version, padding, ID3v1)
+*/
+
+#include "mp3_tag_reader.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define NORMALIZE_PADDING 1024    // Default padding left for later edits
+#define NORMALIZE_MAX_THREADS 64
+
+typedef struct
+{
+    int to;        // Target version 3 or 4, 0 keeps each file's version
+    long padding;  // Padding wanted after the frames
+    int strip_v1;  // Drop a 128-byte ID3v1 trailer
+    int align;     // Keep the audio at its offset within a block so it can be reflinked
+    int dry_run;   // Report only, nothing is written
+} NormalizeOptions;
+
+// One frame of the rewritten tag, data points into the old tag or into owned
+typedef struct
+{
+    unsigned char id[4];
+    unsigned char flags[2];
+    const unsigned char *data;
+    unsigned int size;
+    unsigned char *owned;
+} NormFrame;
+
+typedef struct
+{
+    NormFrame *frames;
+    int count;
+    int capacity;
+    int duplicates;
+    int converted;
+} NormTag;
+
+// Shared by the worker threads, guarded by lock
+typedef struct
+{
+    pthread_mutex_t lock;
+    ScanList *list;
+    int next;
+    const NormalizeOptions *options;
+    BatchJournal *journal;
+    int rewritten;
+    int unchanged;
+    int failed;
+    long long reclaimed;
+} NormalizeJob;
+
+// Single-instance text frames keep their first copy, everything else only drops exact copies
+static Status add_frame(NormTag *tag, const unsigned char *id, const unsigned char *flags, const unsigned char *data,
+                        unsigned int size, unsigned char *owned)
+{
+    const FrameInfo *info = lookup_frame(id, 4);
+    int single = (info != NULL && info->type == FRAME_TEXT);
+
+    for (int i = 0; i < tag->count; i++)
+    {
+        if (memcmp(tag->frames[i].id, id, 4) != 0)
+            continue;
+        if (single || (tag->frames[i].size == size && memcmp(tag->frames[i].data, data, size) == 0))
+        {
+            tag->duplicates++;
+            free(owned);
+            return success;
+        }
+    }
+
+    if (tag->count == tag->capacity)
+    {
+        int capacity = tag->capacity ? tag->capacity * 2 : 32;
+        NormFrame *frames = realloc(tag->frames, capacity * sizeof(NormFrame));
+        if (frames == NULL)
+        {
+            free(owned);
+            return failure;
+        }
+        tag->frames = frames;
+        tag->capacity = capacity;
+    }
+
+    NormFrame *frame = &tag->frames[tag->count++];
+    memcpy(frame->id, id, 4);
+    memcpy(frame->flags, flags, 2);
+    frame->data = data;
+    frame->size = size;
+    frame->owned = owned;
+    return success;
+}
+
+// Encodes a text value as a new frame of the target version
+static Status add_text_frame(NormTag *tag, const char *id, const char *value, unsigned char version)
+{
+    static const unsigned char no_flags[2] = {0, 0};
+    const FrameInfo *info = lookup_frame((const unsigned char *)id, 4);
+    unsigned int len = strlen(value) * 2 + 16;
+    unsigned char *out = malloc(len);
+    if (info == NULL || out == NULL)
+    {
+        free(out);
+        return failure;
+    }
+
+    unsigned int size = frame_encoder(info)(value, version, out, len);
+    if (size == 0)
+    {
+        free(out);
+        return failure;
+    }
+    tag->converted++;
+    return add_frame(tag, (const unsigned char *)info->id, no_flags, out, size, out);
+}
+
+static void free_norm_tag(NormTag *tag)
+{
+    for (int i = 0; i < tag->count; i++)
+        free(tag->frames[i].owned);
+    free(tag->frames);
+    memset(tag, 0, sizeof(*tag));
+}
+
+static size_t put_utf8(char *out, unsigned int cp)
+{
+    if (cp < 0x80)
+    {
+        out[0] = cp;
+        return 1;
+    }
+    if (cp < 0x800)
+    {
+        out[0] = 0xC0 | (cp >> 6);
+        out[1] = 0x80 | (cp & 0x3F);
+        return 2;
+    }
+    if (cp < 0x10000)
+    {
+        out[0] = 0xE0 | (cp >> 12);
+        out[1] = 0x80 | ((cp >> 6) & 0x3F);
+        out[2] = 0x80 | (cp & 0x3F);
+        return 3;
+    }
+    out[0] = 0xF0 | (cp >> 18);
+    out[1] = 0x80 | ((cp >> 12) & 0x3F);
+    out[2] = 0x80 | ((cp >> 6) & 0x3F);
+    out[3] = 0x80 | (cp & 0x3F);
+    return 4;
+}
+
+// Decodes one UTF-16 value starting at pos into out, returns the position after its terminator
+static unsigned int utf16_value(const unsigned char *data, unsigned int size, unsigned int pos, int big_endian,
+                                char *out, size_t *len)
+{
+    // Each value may start with its own byte order mark
+    if (pos + 1 < size && ((data[pos] == 0xFF && data[pos + 1] == 0xFE) || (data[pos] == 0xFE && data[pos + 1] == 0xFF)))
+    {
+        big_endian = (data[pos] == 0xFE);
+        pos += 2;
+    }
+
+    for (; pos + 1 < size; pos += 2)
+    {
+        unsigned int cp = big_endian ? (data[pos] << 8 | data[pos + 1]) : (data[pos + 1] << 8 | data[pos]);
+        if (cp == 0)
+            break;
+        if (cp >= 0xD800 && cp < 0xDC00 && pos + 3 < size)
+        {
+            unsigned int low = big_endian ? (data[pos + 2] << 8 | data[pos + 3]) : (data[pos + 3] << 8 | data[pos + 2]);
+            if (low >= 0xDC00 && low < 0xE000)
+            {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                pos += 2;
+            }
+        }
+        if (cp >= 0xD800 && cp < 0xE000)
+            cp = '?'; // Unpaired surrogate
+        *len += put_utf8(&out[*len], cp);
+    }
+    return pos + 2;
+}
+
+/*
+ * Every NUL-separated value of a text frame as UTF-8, joined with separator, *values says how many there
+ * were. Unlike the display decoders nothing is cut or replaced: the buffer is sized from the frame (UTF-8
+ * needs at most two bytes per ISO-8859-1 byte and three per UTF-16 unit). Returns NULL when out of memory.
+ */
+static char *text_values(const unsigned char *data, unsigned int size, char separator, int *values)
+{
+    char *out = malloc(2 * (size_t)size + 2);
+    size_t len = 0;
+    *values = 0;
+    if (out == NULL)
+        return NULL;
+
+    unsigned char encoding = (size > 0) ? data[0] : 0;
+    for (unsigned int pos = 1; pos < size;)
+    {
+        size_t value_start = len;
+        if ((*values)++ > 0)
+            out[len++] = separator;
+
+        if (encoding == 1 || encoding == 2)
+            pos = utf16_value(data, size, pos, encoding == 2, out, &len);
+        else
+        {
+            for (; pos < size && data[pos] != 0; pos++)
+                len += (encoding == 3) ? (out[len] = data[pos], 1) : put_utf8(&out[len], data[pos]);
+            pos++;
+        }
+
+        // An empty value behind the last terminator is not another value
+        if (pos >= size && *values > 1 && len == value_start + 1)
+        {
+            len = value_start;
+            (*values)--;
+        }
+    }
+    out[len] = '\0';
+    return out;
+}
+
+// Values of the first frame with this ID in the old tag, empty if there is none, NULL when out of memory
+static char *find_text(const unsigned char *tag, unsigned int start, unsigned int end, unsigned char version, const char *id)
+{
+    int values;
+    for (unsigned int pos = start; pos + 10 <= end && tag[pos] != 0;)
+    {
+        unsigned int size = decode_frame_size((unsigned char *)&tag[pos + 4], version);
+        if (size > end - pos - 10)
+            break;
+        if (memcmp(&tag[pos], id, 4) == 0)
+            return text_values(&tag[pos + 10], size, '/', &values);
+        pos += 10 + size;
+    }
+    return strdup("");
+}
+
+// TYER with TDAT (DDMM) and TIME (HHMM) becomes one v2.4 TDRC timestamp
+static Status merge_date(NormTag *tag, const unsigned char *buffer, unsigned int start, unsigned int end,
+                         unsigned char from, const unsigned char *data, unsigned int size)
+{
+    int values;
+    char *year = text_values(data, size, '/', &values);
+    char *date = find_text(buffer, start, end, from, "TDAT");
+    char *time = find_text(buffer, start, end, from, "TIME");
+    char *merged = year ? malloc(strlen(year) + 32) : NULL;
+    Status status = failure;
+
+    if (merged != NULL && date != NULL && time != NULL)
+    {
+        if (strlen(date) == 4)
+        {
+            sprintf(merged, "%.4s-%.2s-%.2s", year, &date[2], date);
+            if (strlen(time) == 4)
+                sprintf(merged + strlen(merged), "T%.2s:%.2s", time, &time[2]);
+        }
+        else
+            strcpy(merged, year);
+        status = add_text_frame(tag, "TDRC", merged, 4);
+    }
+
+    free(year);
+    free(date);
+    free(time);
+    free(merged);
+    return status;
+}
+
+// A v2.4 TDRC timestamp (yyyy-MM-ddTHH:mm:ss) becomes TYER, TDAT and TIME
+static Status split_date(NormTag *tag, const unsigned char *data, unsigned int size)
+{
+    int values;
+    char *value = text_values(data, size, '/', &values);
+    if (value == NULL)
+        return failure;
+
+    char part[8];
+    size_t len = strlen(value);
+    snprintf(part, sizeof(part), "%.4s", value);
+    Status status = add_text_frame(tag, "TYER", part, 3);
+    if (status == success && len >= 10)
+    {
+        snprintf(part, sizeof(part), "%.2s%.2s", &value[8], &value[5]);
+        status = add_text_frame(tag, "TDAT", part, 3);
+    }
+    if (status == success && len >= 16)
+    {
+        snprintf(part, sizeof(part), "%.2s%.2s", &value[11], &value[14]);
+        status = add_text_frame(tag, "TIME", part, 3);
+    }
+
+    free(value);
+    return status;
+}
+
+// Frame status flags moved one bit to the right in v2.4, format flags changed meaning entirely
+static Status convert_frames(const unsigned char *buffer, unsigned int start, unsigned int end, unsigned char from,
+                             unsigned char to, NormTag *tag, const char *path, unsigned int *frames_end)
+{
+    unsigned int pos = start;
+    for (; pos + 10 <= end && buffer[pos] != 0;)
+    {
+        const unsigned char *id = &buffer[pos];
+        unsigned int size = decode_frame_size((unsigned char *)&buffer[pos + 4], from);
+        for (int i = 0; i < 4; i++)
+        {
+            if (!((id[i] >= 'A' && id[i] <= 'Z') || (id[i] >= '0' && id[i] <= '9')))
+            {
+                fprintf(stderr, "❌ Error: Invalid frame ID in '%s'\n", path);
+                return failure;
+            }
+        }
+        if (size > end - pos - 10)
+        {
+            fprintf(stderr, "❌ Error: Frame %.4s overruns the tag in '%s'\n", id, path);
+            return failure;
+        }
+
+        const unsigned char *data = &buffer[pos + 10];
+        const FrameInfo *info = lookup_frame(id, 4);
+        unsigned char flags[2] = {buffer[pos + 8], buffer[pos + 9]};
+        pos += 10 + size;
+
+        if (from == to)
+        {
+            if (add_frame(tag, id, flags, data, size, NULL) != success)
+                return failure;
+            continue;
+        }
+
+        // Compressed, encrypted or per-frame unsynchronised data is not rewritten across versions
+        if (flags[1] != 0)
+        {
+            fprintf(stderr, "❌ Error: Frame %.4s in '%s' has format flags, cannot convert its version\n", id, path);
+            return failure;
+        }
+        flags[0] = (to == 4) ? flags[0] >> 1 : flags[0] << 1;
+
+        // Date frames are merged or split, the rest keep their ID
+        if (to == 4 && memcmp(id, "TYER", 4) == 0)
+        {
+            if (merge_date(tag, buffer, start, end, from, data, size) != success)
+                return failure;
+            continue;
+        }
+        if (to == 4 && (memcmp(id, "TDAT", 4) == 0 || memcmp(id, "TIME", 4) == 0 || memcmp(id, "TRDA", 4) == 0 ||
+                        memcmp(id, "TSIZ", 4) == 0))
+        {
+            tag->converted++; // Folded into TDRC or deprecated in v2.4
+            continue;
+        }
+        if (to == 3 && memcmp(id, "TDRC", 4) == 0)
+        {
+            if (split_date(tag, data, size) != success)
+                return failure;
+            continue;
+        }
+        if (memcmp(id, (to == 4) ? "TORY" : "TDOR", 4) == 0)
+        {
+            int values;
+            char *value = text_values(data, size, '/', &values);
+            if (value != NULL && to == 3 && strlen(value) > 4)
+                value[4] = '\0'; // Only the year survives in TORY
+            Status added = value ? add_text_frame(tag, (to == 4) ? "TDOR" : "TORY", value, to) : failure;
+            free(value);
+            if (added != success)
+                return failure;
+            continue;
+        }
+
+        // IPLS became TIPL in v2.4 with the same string pairs, a UTF-8 or UTF-16BE TIPL has no v2.3 form and is
+        // dropped below
+        if (memcmp(id, (to == 4) ? "IPLS" : "TIPL", 4) == 0 && !(to == 3 && size > 0 && data[0] >= 2))
+        {
+            tag->converted++;
+            if (add_frame(tag, (const unsigned char *)((to == 4) ? "TIPL" : "IPLS"), flags, data, size, NULL) != success)
+                return failure;
+            continue;
+        }
+
+        // Frames the target version does not define would make the tag invalid: RVAD/RVA2 and EQUA/EQU2 store
+        // their data differently, TMCL, TSOP, TDRL ... have no v2.3 counterpart
+        if (info != NULL && !(info->versions & ((to == 4) ? ID3_V24 : ID3_V23)))
+        {
+            tag->converted++;
+            continue;
+        }
+
+        // v2.3 has no UTF-8, no UTF-16BE and one value per text frame: text frames are re-encoded with their
+        // values joined by '/', other frames with such strings stop the file
+        if (to == 3 && size > 0 && info != NULL && info->type == FRAME_TEXT)
+        {
+            int values;
+            char *value = text_values(data, size, '/', &values);
+            if (value == NULL)
+                return failure;
+            Status added = (data[0] >= 2 || values > 1) ? add_text_frame(tag, info->id, value, to)
+                                                         : add_frame(tag, id, flags, data, size, NULL);
+            free(value);
+            if (added != success)
+                return failure;
+            continue;
+        }
+        if (to == 3 && size > 0 && data[0] >= 2 && info != NULL && info->type != FRAME_URL && info->type != FRAME_BINARY)
+        {
+            fprintf(stderr, "❌ Error: Frame %.4s in '%s' is UTF-8 or UTF-16BE, which ID3v2.3 cannot hold\n", id, path);
+            return failure;
+        }
+
+        if (add_frame(tag, id, flags, data, size, NULL) != success)
+            return failure;
+    }
+
+    *frames_end = pos;
+    return success;
+}
+
+static Status read_all(int fd, unsigned char *buffer, size_t len, off_t offset)
+{
+    while (len > 0)
+    {
+        ssize_t n = pread(fd, buffer, len, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return failure;
+        buffer += n;
+        len -= n;
+        offset += n;
+    }
+    return success;
+}
+
+static Status write_all(int fd, const unsigned char *buffer, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(fd, buffer, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return failure;
+        buffer += n;
+        len -= n;
+    }
+    return success;
+}
+
+// The rename only survives a crash once the directory entry is on disk
+static Status sync_parent_dir(const char *path)
+{
+    char dir[4096];
+    const char *slash = strrchr(path, '/');
+    if (slash == NULL)
+        strcpy(dir, ".");
+    else
+        snprintf(dir, sizeof(dir), "%.*s", (slash == path) ? 1 : (int)(slash - path), path);
+
+    int fd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (fd < 0 || fsync(fd) != 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to sync directory '%s': %s\n", dir, strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        return failure;
+    }
+    close(fd);
+    return success;
+}
+
+// Builds the new tag in memory and rewrites the file through a temporary file and rename
+static Status normalize_file(const char *path, const NormalizeOptions *options, long long *reclaimed, int *changed)
+{
+    unsigned char header[10];
+    unsigned char *old_tag = NULL, *new_tag = NULL;
+    NormTag tag = {0};
+    Status status = failure;
+    struct stat st;
+    *reclaimed = 0;
+    *changed = 0;
+
+    int src = open(path, O_RDONLY);
+    if (src < 0 || fstat(src, &st) != 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to open file '%s': %s\n", path, strerror(errno));
+        if (src >= 0)
+            close(src);
+        return failure;
+    }
+
+    if (st.st_size < 10 || read_all(src, header, 10, 0) != success || strncmp((char *)header, "ID3", 3) != 0)
+    {
+        fprintf(stderr, "❌ Error: No ID3v2 tag in '%s'\n", path);
+        goto out;
+    }
+
+    unsigned char from = header[3];
+    unsigned char to = options->to ? options->to : from;
+    if (from != 3 && from != 4)
+    {
+        fprintf(stderr, "❌ Error: ID3v2.%d tag in '%s' is not supported\n", from, path);
+        goto out;
+    }
+    if (header[5] & 0x80)
+    {
+        fprintf(stderr, "❌ Error: Unsynchronised tag in '%s' is not supported\n", path);
+        goto out;
+    }
+
+    unsigned int old_size = convert_big_endian_to_little_endian(&header[6]);
+    off_t old_audio = id3_audio_offset(from, header[5], old_size);
+    if (old_audio > st.st_size)
+    {
+        fprintf(stderr, "❌ Error: Tag size is larger than the file '%s'\n", path);
+        goto out;
+    }
+
+    old_tag = malloc(old_audio);
+    if (old_tag == NULL || read_all(src, old_tag, old_audio, 0) != success)
+    {
+        fprintf(stderr, "❌ Error: Unable to read the tag of '%s'\n", path);
+        goto out;
+    }
+
+    // The extended header is optional and dropped, its CRC would not match the new tag anyway
+    unsigned int start = 10;
+    if (header[5] & 0x40)
+    {
+        if (old_size < 4)
+            goto out;
+        unsigned int ext = (from == 4) ? convert_big_endian_to_little_endian(&old_tag[10]) : decode_frame_size(&old_tag[10], 3) + 4;
+        if (ext > old_size)
+        {
+            fprintf(stderr, "❌ Error: Extended header overruns the tag in '%s'\n", path);
+            goto out;
+        }
+        start += ext;
+    }
+
+    unsigned int frames_end;
+    if (convert_frames(old_tag, start, 10 + old_size, from, to, &tag, path, &frames_end) != success)
+        goto out;
+
+    // Audio length, without the ID3v1 trailer when it is stripped
+    off_t audio_len = st.st_size - old_audio;
+    int strip = 0;
+    unsigned char trailer[3];
+    if (options->strip_v1 && audio_len >= 128 && read_all(src, trailer, 3, st.st_size - 128) == success &&
+        memcmp(trailer, "TAG", 3) == 0)
+    {
+        audio_len -= 128;
+        strip = 1;
+    }
+
+    off_t frames_len = 0;
+    for (int i = 0; i < tag.count; i++)
+        frames_len += 10 + tag.frames[i].size;
+
+    // Optionally round the padding up so the audio keeps its offset within a block and can still be reflinked
+    long block = reflink_block_size(src);
+    off_t new_audio = 10 + frames_len + options->padding;
+    if (options->align)
+        new_audio += ((old_audio - new_audio) % block + block) % block;
+    if (new_audio - 10 > 0x0FFFFFFF)
+    {
+        fprintf(stderr, "❌ Error: Normalized tag of '%s' is too large\n", path);
+        goto out;
+    }
+
+    new_tag = calloc(1, new_audio);
+    if (new_tag == NULL)
+        goto out;
+    memcpy(new_tag, "ID3", 3);
+    new_tag[3] = to;
+    convert_int_to_synchsafe((unsigned int)(new_audio - 10), &new_tag[6]);
+    off_t pos = 10;
+    for (int i = 0; i < tag.count; i++)
+    {
+        memcpy(&new_tag[pos], tag.frames[i].id, 4);
+        encode_frame_size(tag.frames[i].size, to, &new_tag[pos + 4]);
+        memcpy(&new_tag[pos + 8], tag.frames[i].flags, 2);
+        memcpy(&new_tag[pos + 10], tag.frames[i].data, tag.frames[i].size);
+        pos += 10 + tag.frames[i].size;
+    }
+
+    // Nothing to do when the frames come out byte for byte the same and the padding is within a factor of two
+    off_t old_padding = 10 + (off_t)old_size - frames_end;
+    if (!strip && from == to && header[5] == 0 && frames_end - start == frames_len &&
+        memcmp(&old_tag[start], &new_tag[10], frames_len) == 0 && old_padding >= options->padding / 2 &&
+        old_padding <= options->padding * 2 + block)
+    {
+        status = success;
+        goto out;
+    }
+
+    *changed = 1;
+    *reclaimed = (long long)st.st_size - (new_audio + audio_len);
+    printf("🧹 %s: v2.%d -> v2.%d, %d duplicate(s), %d frame(s) converted, padding %lld -> %lld%s, %lld byte(s) reclaimed\n",
+           path, from, to, tag.duplicates, tag.converted, (long long)old_padding,
+           (long long)(new_audio - pos), strip ? ", ID3v1 stripped" : "", *reclaimed);
+
+    if (options->dry_run)
+    {
+        status = success;
+        goto out;
+    }
+
+    // Same directory, so the rename replaces the original atomically and the audio can be reflinked,
+    // under a unique name so no other file in the directory is overwritten
+    char tmp_path[4200];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path) >= (int)sizeof(tmp_path))
+    {
+        fprintf(stderr, "❌ Error: File path '%s' is too long\n", path);
+        goto out;
+    }
+    int dst = mkstemp(tmp_path);
+    if (dst < 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to create a temporary file next to '%s': %s\n", path, strerror(errno));
+        goto out;
+    }
+    fchmod(dst, st.st_mode & 07777); // mkstemp creates the file 0600
+
+    if (write_all(dst, new_tag, new_audio) != success || copy_audio_region(src, old_audio, dst, new_audio) != success ||
+        (strip && ftruncate(dst, new_audio + audio_len) != 0) || fsync(dst) != 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to write '%s', original left untouched\n", tmp_path);
+        close(dst);
+        unlink(tmp_path);
+        goto out;
+    }
+    close(dst);
+
+    if (rename(tmp_path, path) != 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to replace '%s': %s\n", path, strerror(errno));
+        unlink(tmp_path);
+        goto out;
+    }
+    status = sync_parent_dir(path);
+
+out:
+    free_norm_tag(&tag);
+    free(old_tag);
+    free(new_tag);
+    close(src);
+    return status;
+}
+
+static void *normalize_worker(void *arg)
+{
+    NormalizeJob *job = arg;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&job->lock);
+        int i = job->next++;
+        pthread_mutex_unlock(&job->lock);
+        if (i >= job->list->count)
+            break;
+
+        const char *path = job->list->entries[i].path;
+        long long reclaimed;
+        int changed;
+        Status status = normalize_file(path, job->options, &reclaimed, &changed);
+
+        // The journal and the totals are shared
+        pthread_mutex_lock(&job->lock);
+        if (status == success)
+        {
+            job->reclaimed += reclaimed;
+            if (changed)
+                job->rewritten++;
+            else
+                job->unchanged++;
+            batch_mark_done(job->journal, path);
+        }
+        else
+        {
+            job->failed++;
+            batch_mark_failed(job->journal);
+        }
+        pthread_mutex_unlock(&job->lock);
+    }
+    return NULL;
+}
+
+// Both conversions of one file with nothing written, for the fuzz harness
+Status normalize_check(const char *path)
+{
+    NormalizeOptions options = {0, NORMALIZE_PADDING, 1, 1, 1};
+    long long reclaimed;
+    int changed;
+    Status status = success;
+
+    for (options.to = 3; options.to <= 4; options.to++)
+    {
+        if (normalize_file(path, &options, &reclaimed, &changed) != success)
+            status = failure;
+    }
+    return status;
+}
+
+Status normalize(int argc, char *argv[])
+{
+    NormalizeOptions options = {0, NORMALIZE_PADDING, 0, 0, 0};
+    const char *journal_path = NULL;
+    long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    ScanList list = {0};
+    Status status = success;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--to") == 0 && i + 1 < argc)
+            options.to = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--padding") == 0 && i + 1 < argc)
+            options.padding = atol(argv[++i]);
+        else if (strcmp(argv[i], "--strip-v1") == 0)
+            options.strip_v1 = 1;
+        else if (strcmp(argv[i], "--align") == 0)
+            options.align = 1;
+        else if (strcmp(argv[i], "--dry-run") == 0)
+            options.dry_run = 1;
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            nthreads = atol(argv[++i]);
+        else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc)
+            journal_path = argv[++i];
+        else if (collect_mp3_files(argv[i], &list) != success)
+            status = failure;
+    }
+
+    if ((options.to != 0 && options.to != 3 && options.to != 4) || options.padding < 0 || options.padding > 0x0FFFFFFF)
+    {
+        fprintf(stderr, "❌ Error: --to takes 3 or 4 and --padding a byte count\n");
+        free_scan_list(&list);
+        return failure;
+    }
+    if (list.count == 0)
+    {
+        fprintf(stderr, "❌ Error: No MP3 files found\n");
+        free_scan_list(&list);
+        return failure;
+    }
+
+    BatchJournal journal;
+    if (batch_journal_open(&journal, options.dry_run ? NULL : journal_path, list.count) != success)
+    {
+        free_scan_list(&list);
+        return failure;
+    }
+
+    int kept = 0;
+    for (int i = 0; i < list.count; i++)
+    {
+        if (batch_is_done(&journal, list.entries[i].path))
+            free(list.entries[i].path);
+        else
+            list.entries[kept++] = list.entries[i];
+    }
+    list.count = kept;
+    sort_by_disk_location(&list);
+
+    if (nthreads < 1)
+        nthreads = 1;
+    if (nthreads > NORMALIZE_MAX_THREADS)
+        nthreads = NORMALIZE_MAX_THREADS;
+
+    NormalizeJob job = {.list = &list, .options = &options, .journal = &journal};
+    pthread_mutex_init(&job.lock, NULL);
+
+    // Files are handed out one at a time, each is independent of the others
+    pthread_t threads[NORMALIZE_MAX_THREADS];
+    int started = 0;
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (pthread_create(&threads[started], NULL, normalize_worker, &job) == 0)
+            started++;
+    }
+    if (started == 0)
+        normalize_worker(&job);
+    for (int t = 0; t < started; t++)
+        pthread_join(threads[t], NULL);
+    pthread_mutex_destroy(&job.lock);
+
+    batch_journal_close(&journal);
+    printf("♻️  %d file(s) %s, %d already normal, %d failed, %lld byte(s) %s\n", job.rewritten,
+           options.dry_run ? "would be rewritten" : "rewritten", job.unchanged, job.failed, job.reclaimed,
+           options.dry_run ? "reclaimable" : "reclaimed");
+
+    free_scan_list(&list);
+    return (status == success && job.failed == 0) ? success : failure;
+}
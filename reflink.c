@@ -0,0 +1,306 @@
+/*
+Documentation
+Name        : Vamsi T
+Date        : 30/7/25
+Description : MP3 Tag Reader project - reflink / fast copy of the audio region
+*/
+
+#define _GNU_SOURCE
+#include "mp3_tag_reader.h"
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <linux/fs.h>
+
+#define COPY_CHUNK_SIZE (64 * 1024)
+
+long reflink_block_size(int fd)
+{
+    struct stat st;
+
+    // Clone ranges must be aligned to the filesystem block size
+    if (fstat(fd, &st) != 0 || st.st_blksize <= 0)
+        return 4096;
+
+    return st.st_blksize;
+}
+
+static Status copy_fd_data(int src_fd, off_t src_offset, int dst_fd, off_t dst_offset, off_t length)
+{
+    // length < 0 means copy until end of the source file
+    int to_eof = length < 0;
+
+    // Try copy_file_range first, the kernel may share extents or copy without user space buffers
+    while (to_eof || length > 0)
+    {
+        loff_t in = src_offset, out = dst_offset;
+        size_t want = (to_eof || length > COPY_CHUNK_SIZE * 16) ? COPY_CHUNK_SIZE * 16 : (size_t)length;
+        ssize_t n = copy_file_range(src_fd, &in, dst_fd, &out, want, 0);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)
+                break; // Fall back to the buffered copy below
+            perror("❌ copy_file_range failed");
+            return failure;
+        }
+        if (n == 0)
+        {
+            if (to_eof)
+                return success;
+            fprintf(stderr, "❌ Error: Unexpected end of file while copying.\n");
+            return failure;
+        }
+        src_offset += n;
+        dst_offset += n;
+        if (!to_eof)
+            length -= n;
+    }
+
+    if (!to_eof && length == 0)
+        return success;
+
+    // Buffered fallback
+    char buffer[COPY_CHUNK_SIZE];
+    while (to_eof || length > 0)
+    {
+        size_t want = (to_eof || length > COPY_CHUNK_SIZE) ? COPY_CHUNK_SIZE : (size_t)length;
+        ssize_t n = pread(src_fd, buffer, want, src_offset);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("❌ Error reading from original MP3 file");
+            return failure;
+        }
+        if (n == 0)
+        {
+            if (to_eof)
+                return success;
+            fprintf(stderr, "❌ Error: Unexpected end of file while copying.\n");
+            return failure;
+        }
+
+        ssize_t done = 0;
+        while (done < n)
+        {
+            ssize_t w = pwrite(dst_fd, buffer + done, n - done, dst_offset + done);
+            if (w < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                perror("❌ Error writing content to new file");
+                return failure;
+            }
+            done += w;
+        }
+
+        src_offset += n;
+        dst_offset += n;
+        if (!to_eof)
+            length -= n;
+    }
+
+    return success;
+}
+
+Status copy_fd_range(int src_fd, off_t src_offset, int dst_fd, off_t dst_offset, off_t length)
+{
+    struct stat st;
+
+    // Fully allocated sources (the usual case) are copied in one go
+    if (fstat(src_fd, &st) != 0 || (off_t)st.st_blocks * 512 >= st.st_size)
+        return copy_fd_data(src_fd, src_offset, dst_fd, dst_offset, length);
+
+    // Sparse source: copy only the data extents and leave the holes unwritten, callers append to a new file
+    off_t end = (length < 0) ? st.st_size : src_offset + length;
+    while (src_offset < end)
+    {
+        off_t data = lseek(src_fd, src_offset, SEEK_DATA);
+        if (data < 0 && errno == ENXIO)
+            data = end; // Only a hole is left
+        else if (data < 0)
+            return copy_fd_data(src_fd, src_offset, dst_fd, dst_offset, end - src_offset);
+        if (data > end)
+            data = end;
+
+        off_t hole = (data < end) ? lseek(src_fd, data, SEEK_HOLE) : end;
+        if (hole < 0 || hole > end)
+            hole = end;
+
+        dst_offset += data - src_offset;
+        if (hole > data && copy_fd_data(src_fd, data, dst_fd, dst_offset, hole - data) != success)
+            return failure;
+        dst_offset += hole - data;
+        src_offset = hole;
+    }
+
+    // A trailing hole still has to extend the destination
+    if (fstat(dst_fd, &st) != 0 || (st.st_size < dst_offset && ftruncate(dst_fd, dst_offset) != 0))
+    {
+        perror("❌ Error extending new file");
+        return failure;
+    }
+    return success;
+}
+
+Status copy_audio_region(int src_fd, off_t src_offset, int dst_fd, off_t dst_offset)
+{
+    long block = reflink_block_size(dst_fd);
+    struct stat st;
+
+#ifdef FICLONERANGE
+    // Source and destination must sit at the same position inside a block to share extents,
+    // and there must be at least one whole block of audio after the partial one
+    if (src_offset % block == dst_offset % block && fstat(src_fd, &st) == 0 &&
+        src_offset + (block - src_offset % block) % block < st.st_size)
+    {
+        off_t head = (block - src_offset % block) % block;
+
+        // Copy the partial block in front of the first aligned block
+        if (head > 0 && copy_fd_range(src_fd, src_offset, dst_fd, dst_offset, head) != success)
+            return failure;
+
+        struct file_clone_range range;
+        range.src_fd = src_fd;
+        range.src_offset = src_offset + head;
+        range.src_length = 0; // Until end of the source file
+        range.dest_offset = dst_offset + head;
+
+        if (ioctl(dst_fd, FICLONERANGE, &range) == 0)
+        {
+            printf("🔗 Audio data reflinked (no data copied)\n");
+            return success;
+        }
+
+        // EOPNOTSUPP / EXDEV / EINVAL: filesystem or alignment does not allow it
+        printf("ℹ️  Reflink not available (%s), copying audio data\n", strerror(errno));
+        src_offset += head;
+        dst_offset += head;
+    }
+    else
+    {
+        printf("ℹ️  Audio offset not block aligned or audio too short, copying audio data\n");
+    }
+#else
+    (void)st;
+#endif
+
+    return copy_fd_range(src_fd, src_offset, dst_fd, dst_offset, -1);
+}
+
+// FNV-1a, 64 bit, starting from CHECKSUM_INIT
+unsigned long long checksum_update(unsigned long long hash, const unsigned char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Where the audio of a file starts according to its own ID3v2 header
+static Status header_audio_offset(int fd, off_t *offset)
+{
+    unsigned char header[10];
+    if (pread(fd, header, sizeof(header), 0) != sizeof(header) || memcmp(header, "ID3", 3) != 0 ||
+        ((header[6] | header[7] | header[8] | header[9]) & 0x80))
+        return failure;
+
+    *offset = id3_audio_offset(header[3], header[5], convert_big_endian_to_little_endian(&header[6]));
+    return success;
+}
+
+Status copy_audio_verified(int src_fd, off_t src_offset, int dst_fd, off_t dst_offset)
+{
+    unsigned char buffer[COPY_CHUNK_SIZE], check[COPY_CHUNK_SIZE];
+    unsigned long long src_hash = CHECKSUM_INIT, dst_hash = src_hash;
+    off_t copied = 0;
+
+    // The header is written before the audio, so the new file already says where its audio starts.
+    // Reading back from there rather than from dst_offset catches a wrong tag size or frame length.
+    off_t check_offset;
+    if (header_audio_offset(dst_fd, &check_offset) != success)
+    {
+        fprintf(stderr, "❌ Error: New file has no valid ID3v2 header, original left untouched.\n");
+        return failure;
+    }
+    if (check_offset != dst_offset)
+        fprintf(stderr, "⚠️  New header puts the audio at %lld, it is being written at %lld\n", (long long)check_offset,
+                (long long)dst_offset);
+
+    // One pass: each chunk is hashed as read and written, then the same range of the new file's audio is
+    // read back and hashed. The read-back hits pages just written, so the only disk read is the source.
+    for (;;)
+    {
+        ssize_t n = pread(src_fd, buffer, sizeof(buffer), src_offset + copied);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("❌ Error reading from original MP3 file");
+            return failure;
+        }
+        if (n == 0)
+            break;
+        src_hash = checksum_update(src_hash, buffer, n);
+
+        // All-zero chunks (holes in a sparse source) extend the new file instead of being written, so it
+        // stays sparse and still reads back as zeros
+        ssize_t nonzero = 0;
+        while (nonzero < n && buffer[nonzero] == 0)
+            nonzero++;
+        if (nonzero == n && ftruncate(dst_fd, dst_offset + copied + n) != 0)
+        {
+            perror("❌ Error extending new file");
+            return failure;
+        }
+
+        for (ssize_t done = (nonzero == n) ? n : 0; done < n;)
+        {
+            ssize_t w = pwrite(dst_fd, buffer + done, n - done, dst_offset + copied + done);
+            if (w < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                perror("❌ Error writing content to new file");
+                return failure;
+            }
+            done += w;
+        }
+
+        // A short read means the new file ends before the audio does, the size check below reports it
+        ssize_t done = 0;
+        while (done < n)
+        {
+            ssize_t r = pread(dst_fd, check + done, n - done, check_offset + copied + done);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r < 0)
+            {
+                fprintf(stderr, "❌ Error: Unable to read back the new file for verification.\n");
+                return failure;
+            }
+            if (r == 0)
+                break;
+            done += r;
+        }
+        dst_hash = checksum_update(dst_hash, check, done);
+        copied += n;
+    }
+
+    // The new file must end exactly where its header says the copied audio ends
+    struct stat st;
+    if (fstat(dst_fd, &st) != 0 || st.st_size != check_offset + copied || src_hash != dst_hash)
+    {
+        fprintf(stderr, "❌ Error: Audio verification failed (source %016llx, result %016llx), original left untouched.\n",
+                src_hash, dst_hash);
+        return failure;
+    }
+
+    printf("🔒 Audio verified: %lld bytes, checksum %016llx\n", (long long)copied, src_hash);
+    return success;
+}
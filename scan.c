@@ -0,0 +1,380 @@
+/*
+Documentation
+Name        : Vamsi T
+Date        : 30/7/25
+Description : MP3 Tag Reader project - library scan in disk order with readahead hints
+*/
+
+#define _GNU_SOURCE
+#include "mp3_tag_reader.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+
+#define SCAN_READAHEAD (64 * 1024) // Guess for the tag range before the header is read
+#define SCAN_BENCH_ROUNDS 2          // Each round runs both orders
+
+static Status add_scan_entry(ScanList *list, const char *path)
+{
+    if (list->count == list->capacity)
+    {
+        int capacity = list->capacity ? list->capacity * 2 : 256;
+        ScanEntry *entries = realloc(list->entries, capacity * sizeof(ScanEntry));
+        if (entries == NULL)
+        {
+            fprintf(stderr, "❌ Memory allocation failed.\n");
+            return failure;
+        }
+        list->entries = entries;
+        list->capacity = capacity;
+    }
+
+    ScanEntry *entry = &list->entries[list->count];
+    entry->path = strdup(path);
+    if (entry->path == NULL)
+    {
+        fprintf(stderr, "❌ Memory allocation failed.\n");
+        return failure;
+    }
+    entry->location = 0;
+    entry->fd = -1;
+    list->count++;
+    return success;
+}
+
+Status collect_mp3_files(const char *path, ScanList *list)
+{
+    struct stat st;
+    if (lstat(path, &st) != 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to access '%s': %s\n", path, strerror(errno));
+        return failure;
+    }
+
+    if (S_ISREG(st.st_mode))
+        return is_mp3_filename(path) ? add_scan_entry(list, path) : success;
+
+    if (!S_ISDIR(st.st_mode))
+        return success;
+
+    DIR *dir = opendir(path);
+    if (dir == NULL)
+    {
+        fprintf(stderr, "❌ Error: Unable to open directory '%s': %s\n", path, strerror(errno));
+        return failure;
+    }
+
+    // Directory order, this is what the disk-order sort improves on
+    Status status = success;
+    struct dirent *de;
+    char child[4096];
+    while ((de = readdir(dir)) != NULL)
+    {
+        if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0)
+            continue;
+        if (snprintf(child, sizeof(child), "%s/%s", path, de->d_name) >= (int)sizeof(child))
+            continue;
+        if (collect_mp3_files(child, list) != success)
+            status = failure;
+    }
+
+    closedir(dir);
+    return status;
+}
+
+void free_scan_list(ScanList *list)
+{
+    for (int i = 0; i < list->count; i++)
+    {
+        if (list->entries[i].fd >= 0)
+            close(list->entries[i].fd);
+        free(list->entries[i].path);
+    }
+    free(list->entries);
+    list->entries = NULL;
+    list->count = list->capacity = 0;
+}
+
+// Physical offset of the first extent, or the inode number where FIEMAP is not supported
+static unsigned long long disk_location(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return ~0ULL;
+
+    union
+    {
+        struct fiemap map;
+        char buffer[sizeof(struct fiemap) + sizeof(struct fiemap_extent)];
+    } fm;
+    memset(&fm, 0, sizeof(fm));
+    fm.map.fm_start = 0;
+    fm.map.fm_length = FIEMAP_MAX_OFFSET;
+    fm.map.fm_extent_count = 1;
+
+    unsigned long long location;
+    if (ioctl(fd, FS_IOC_FIEMAP, &fm.map) == 0 && fm.map.fm_mapped_extents >= 1)
+    {
+        location = fm.map.fm_extents[0].fe_physical;
+    }
+    else
+    {
+        struct stat st;
+        location = (fstat(fd, &st) == 0) ? (unsigned long long)st.st_ino : ~0ULL;
+    }
+
+    close(fd);
+    return location;
+}
+
+static int compare_location(const void *a, const void *b)
+{
+    const ScanEntry *x = a, *y = b;
+
+    if (x->location != y->location)
+        return x->location < y->location ? -1 : 1;
+    return strcmp(x->path, y->path);
+}
+
+void sort_by_disk_location(ScanList *list)
+{
+    // Only metadata is read here, the data blocks are not touched
+    for (int i = 0; i < list->count; i++)
+        list->entries[i].location = disk_location(list->entries[i].path);
+
+    qsort(list->entries, list->count, sizeof(ScanEntry), compare_location);
+}
+
+// Opens a file ahead of the parser and asks the kernel to start reading its tag
+void prefetch_entry(ScanEntry *entry)
+{
+    if (entry->fd >= 0)
+        return;
+
+    entry->fd = open(entry->path, O_RDONLY);
+    if (entry->fd >= 0)
+        posix_fadvise(entry->fd, 0, SCAN_READAHEAD, POSIX_FADV_WILLNEED);
+}
+
+Status scan_file(ScanEntry *entry, TagRecord *record, off_t *bytes_read, int with_duration)
+{
+    prefetch_entry(entry);
+    if (entry->fd < 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to open file '%s': %s\n", entry->path, strerror(errno));
+        return failure;
+    }
+
+    // Extend the hint to the real tag range once the header is known
+    unsigned char header[10];
+    off_t tag_end = 0;
+    if (pread(entry->fd, header, 10, 0) == 10 && strncmp((char *)header, "ID3", 3) == 0)
+    {
+        tag_end = 10 + (off_t)convert_big_endian_to_little_endian(&header[6]);
+        if (tag_end > SCAN_READAHEAD)
+            posix_fadvise(entry->fd, SCAN_READAHEAD, tag_end - SCAN_READAHEAD, POSIX_FADV_WILLNEED);
+    }
+
+    unsigned char consumed[10];
+    long consumed_len;
+    Status status = stream_read_tags(entry->fd, record, consumed, &consumed_len);
+    if (status != success)
+        fprintf(stderr, "❌ Error: Truncated or malformed ID3v2 tag in '%s'\n", entry->path);
+
+    // Reads past the tag and near the end of the file, only done when the caller outputs it
+    record->duration_ms = 0;
+    if (status == success && with_duration)
+        record->duration_ms =
+            audio_duration_ms(entry->fd, tag_end ? id3_audio_offset(header[3], header[5], tag_end - 10) : 0);
+
+    // The tag pages will not be needed again
+    posix_fadvise(entry->fd, 0, tag_end > SCAN_READAHEAD ? tag_end : SCAN_READAHEAD, POSIX_FADV_DONTNEED);
+    *bytes_read += tag_end ? tag_end : consumed_len;
+
+    close(entry->fd);
+    entry->fd = -1;
+    return status;
+}
+
+Status scan_list(ScanList *list, int print_records, off_t *bytes_read, BatchJournal *journal)
+{
+    Status status = success;
+    TagRecord record;
+
+    for (int i = 0; i < list->count; i++)
+    {
+        // Keep a window of files prefetching while this one is parsed
+        for (int j = i + 1; j < list->count && j <= i + SCAN_LOOKAHEAD; j++)
+            prefetch_entry(&list->entries[j]);
+
+        if (scan_file(&list->entries[i], &record, bytes_read, 0) != success)
+        {
+            status = failure;
+            if (journal != NULL)
+                batch_mark_failed(journal);
+            continue;
+        }
+
+        if (print_records)
+            print_record(stdout, list->entries[i].path, &record);
+
+        // Journal only after the record is out
+        if (journal != NULL && batch_mark_done(journal, list->entries[i].path) != success)
+            status = failure;
+    }
+
+    return status;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Evicts the library from the page cache so every pass starts cold. As root the dentry, inode and extent
+// caches are dropped too, otherwise they stay warm and the passes alternate their order to share that out.
+static int drop_cached_pages(ScanList *list)
+{
+    for (int i = 0; i < list->count; i++)
+    {
+        int fd = open(list->entries[i].path, O_RDONLY);
+        if (fd < 0)
+            continue;
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+
+    int fd = (geteuid() == 0) ? open("/proc/sys/vm/drop_caches", O_WRONLY) : -1;
+    if (fd < 0)
+        return 0;
+    sync();
+    int dropped = (write(fd, "3", 1) == 1);
+    close(fd);
+    return dropped;
+}
+
+static double bench_pass(ScanList *list, const ScanEntry *directory_order, const char *name, int sort)
+{
+    off_t bytes = 0;
+
+    // Every pass starts from the order the directories were walked in
+    memcpy(list->entries, directory_order, list->count * sizeof(ScanEntry));
+    int system_wide = drop_cached_pages(list);
+    double start = now_seconds();
+    if (sort)
+        sort_by_disk_location(list); // Part of the cost of the disk-order scan
+    scan_list(list, 0, &bytes, NULL);
+    double elapsed = now_seconds() - start;
+
+    printf("⏱️  %-15s: %d files in %.3f s  (%.1f files/s, %.2f MB/s of tag data)%s\n", name, list->count, elapsed,
+           elapsed > 0 ? list->count / elapsed : 0.0, elapsed > 0 ? bytes / elapsed / (1024 * 1024) : 0.0,
+           system_wide ? "" : "  [metadata caches warm]");
+    return elapsed;
+}
+
+Status scan(int argc, char *argv[])
+{
+    int bench = 0;
+    int workers = 0, by_size = 0;
+    const char *journal_path = NULL;
+    ScanList list = {0};
+    Status status = success;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bench") == 0)
+            bench = 1;
+        else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc)
+            journal_path = argv[++i];
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+            workers = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc)
+            by_size = (strcmp(argv[++i], "size") == 0);
+        else if (collect_mp3_files(argv[i], &list) != success)
+            status = failure;
+    }
+
+    if (list.count == 0)
+    {
+        fprintf(stderr, "❌ Error: No MP3 files found\n");
+        free_scan_list(&list);
+        return failure;
+    }
+
+    if (bench)
+    {
+        // Same files, cold cache, the orders swap places each round (directory, disk, disk, directory ...)
+        // so neither one always runs after the other has warmed whatever the drop left behind
+        ScanEntry *directory_order = malloc(list.count * sizeof(ScanEntry));
+        if (directory_order == NULL)
+        {
+            fprintf(stderr, "❌ Memory allocation failed.\n");
+            free_scan_list(&list);
+            return failure;
+        }
+        memcpy(directory_order, list.entries, list.count * sizeof(ScanEntry));
+
+        double total[2] = {0, 0};
+        printf("🏁 Benchmarking cold-cache scan of %d files, %d rounds...\n", list.count, SCAN_BENCH_ROUNDS);
+        for (int round = 0; round < SCAN_BENCH_ROUNDS; round++)
+        {
+            for (int k = 0; k < 2; k++)
+            {
+                int sort = (round % 2) ? !k : k;
+                total[sort] += bench_pass(&list, directory_order, sort ? "Disk order" : "Directory order", sort);
+            }
+        }
+        printf("📊 Average: directory order %.3f s, disk order %.3f s (%.2fx)\n", total[0] / SCAN_BENCH_ROUNDS,
+               total[1] / SCAN_BENCH_ROUNDS, total[1] > 0 ? total[0] / total[1] : 0.0);
+
+        free(directory_order);
+        free_scan_list(&list);
+        return status;
+    }
+
+    BatchJournal journal;
+    if (batch_journal_open(&journal, journal_path, list.count) != success)
+    {
+        free_scan_list(&list);
+        return failure;
+    }
+
+    // Drop files finished by an earlier run before any of their data is touched
+    int kept = 0;
+    for (int i = 0; i < list.count; i++)
+    {
+        if (batch_is_done(&journal, list.entries[i].path))
+            free(list.entries[i].path);
+        else
+            list.entries[kept++] = list.entries[i];
+    }
+    list.count = kept;
+
+    // Worker processes for libraries too big for one process, merged in path order
+    if (workers > 1 && list.count > 0)
+    {
+        if (scan_sharded(&list, workers, by_size, &journal) != success)
+            status = failure;
+        batch_journal_close(&journal);
+        free_scan_list(&list);
+        return status;
+    }
+
+    sort_by_disk_location(&list);
+    off_t bytes = 0;
+    if (scan_list(&list, 1, &bytes, &journal) != success)
+        status = failure;
+
+    batch_journal_close(&journal);
+    free_scan_list(&list);
+    return status;
+}
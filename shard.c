@@ -0,0 +1,456 @@
+/*
+Documentation
+Name        : Vamsi T
+Date        : 30/7/25
+Description : MP3 Tag Reader project - sharded multi-process scan with merged output
+*/
+
+#include "mp3_tag_reader.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define SHARD_MAX_WORKERS 256
+#define SHARD_CRASH_LIMIT 2 // A file that takes down this many workers is skipped
+#define SHARD_WINDOW 16384  // Files per path-order window, bounds the records held for the merge
+
+// Record sent from a worker to the coordinator, followed by len bytes of record line
+typedef struct
+{
+    int index; // Position in the disk-ordered list
+    int status;
+    unsigned int len;
+} ShardMessage;
+
+// Files of one shard, window by window and in disk order within a window, and the worker scanning them
+typedef struct
+{
+    int *order; // Slice of the shared order array
+    int count;
+    int pos;     // Next file the worker will report
+    int crashes; // Crashes on order[pos]
+    int careful; // No lookahead before this position, so a crash is blamed on the file being parsed
+    pid_t pid;
+    int fd;
+    unsigned char *buffer;
+    size_t have;
+    size_t cap;
+} Shard;
+
+static const ScanList *rank_list;
+static const long long *rank_size;
+
+static int compare_rank(const void *a, const void *b)
+{
+    return strcmp(rank_list->entries[*(const int *)a].path, rank_list->entries[*(const int *)b].path);
+}
+
+// The list is in disk order, so a lower index is further toward the start of the disk
+static int compare_index(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+// Largest first, ties keep disk order
+static int compare_size(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    if (rank_size[x] != rank_size[y])
+        return rank_size[x] > rank_size[y] ? -1 : 1;
+    return x - y;
+}
+
+static unsigned int hash_dir(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    size_t len = slash ? (size_t)(slash - path) : 0;
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= (unsigned char)path[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static Status write_message(int fd, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    while (len > 0)
+    {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return failure;
+        p += n;
+        len -= n;
+    }
+    return success;
+}
+
+// Child side: scans order[pos..] and reports each file, in order
+static void run_worker(ScanList *list, Shard *shard, int fd)
+{
+    char line[RECORD_FIELDS * RECORD_VALUE_LEN + 4200];
+    TagRecord record;
+    off_t bytes = 0;
+
+    for (int p = shard->pos; p < shard->count; p++)
+    {
+        for (int q = p + 1; p >= shard->careful && q < shard->count && q <= p + SCAN_LOOKAHEAD; q++)
+            prefetch_entry(&list->entries[shard->order[q]]);
+
+        ScanEntry *entry = &list->entries[shard->order[p]];
+        ShardMessage message = {shard->order[p], scan_file(entry, &record, &bytes, 0), 0};
+        if (message.status == success)
+        {
+            int len = format_record(line, sizeof(line), entry->path, &record);
+            message.len = (len < 0 || (size_t)len >= sizeof(line)) ? 0 : (unsigned int)len;
+            if (message.len == 0)
+                message.status = failure;
+        }
+
+        if (write_message(fd, &message, sizeof(message)) != success || write_message(fd, line, message.len) != success)
+            _exit(1);
+    }
+    _exit(0);
+}
+
+static Status start_worker(ScanList *list, Shard *shards, int nshards, int s)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        perror("❌ pipe failed");
+        return failure;
+    }
+
+    // Nothing buffered may be written twice by the child
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("❌ fork failed");
+        close(fds[0]);
+        close(fds[1]);
+        return failure;
+    }
+    if (pid == 0)
+    {
+        close(fds[0]);
+        for (int t = 0; t < nshards; t++)
+        {
+            if (shards[t].fd >= 0)
+                close(shards[t].fd);
+        }
+        run_worker(list, &shards[s], fds[1]);
+    }
+
+    close(fds[1]);
+    shards[s].pid = pid;
+    shards[s].fd = fds[0];
+    shards[s].have = 0;
+    return success;
+}
+
+// Takes whole messages out of a worker's buffer, records land in their path rank
+static void take_messages(Shard *shard, const int *rank, char **lines, unsigned char *state)
+{
+    size_t used = 0;
+    while (shard->have - used >= sizeof(ShardMessage))
+    {
+        ShardMessage message;
+        memcpy(&message, shard->buffer + used, sizeof(message));
+        if (shard->have - used - sizeof(message) < message.len)
+            break;
+
+        const char *text = (const char *)shard->buffer + used + sizeof(message);
+        int r = rank[message.index];
+        if (message.status == success)
+        {
+            lines[r] = strndup(text, message.len);
+            state[r] = (lines[r] != NULL) ? 1 : 2;
+        }
+        else
+            state[r] = 2;
+
+        shard->pos++;
+        shard->crashes = 0;
+        used += sizeof(message) + message.len;
+    }
+
+    memmove(shard->buffer, shard->buffer + used, shard->have - used);
+    shard->have -= used;
+}
+
+// Worker gone: done, or restart it where it stopped
+static Status reap_worker(ScanList *list, Shard *shards, int nshards, int s, const int *rank, unsigned char *state,
+                          int *restarts)
+{
+    Shard *shard = &shards[s];
+    int wstatus = 0;
+    close(shard->fd);
+    shard->fd = -1;
+    waitpid(shard->pid, &wstatus, 0);
+    shard->pid = 0;
+
+    if (shard->pos >= shard->count)
+        return success;
+
+    // The file the worker was on when it died is the first one it did not report, unless it died opening
+    // one of the files prefetched after it. The restart goes without lookahead until past that window.
+    int index = shard->order[shard->pos];
+    shard->careful = shard->pos + SCAN_LOOKAHEAD + 1;
+    const char *path = list->entries[index].path;
+    shard->crashes++;
+    if (WIFSIGNALED(wstatus))
+        fprintf(stderr, "💥 Worker for shard %d died with signal %d on '%s'\n", s, WTERMSIG(wstatus), path);
+    else
+        fprintf(stderr, "💥 Worker for shard %d exited with status %d on '%s'\n", s, WEXITSTATUS(wstatus), path);
+
+    if (shard->crashes >= SHARD_CRASH_LIMIT)
+    {
+        fprintf(stderr, "⚠️  Skipping '%s' after %d crashes\n", path, shard->crashes);
+        state[rank[index]] = 2;
+        shard->pos++;
+        shard->crashes = 0;
+        if (shard->pos >= shard->count)
+            return success;
+    }
+
+    (*restarts)++;
+    return start_worker(list, shards, nshards, s);
+}
+
+Status scan_sharded(ScanList *list, int workers, int by_size, BatchJournal *journal)
+{
+    int count = list->count;
+    Status status = success;
+    int restarts = 0, failed = 0;
+
+    if (workers > SHARD_MAX_WORKERS)
+        workers = SHARD_MAX_WORKERS;
+    if (workers > count)
+        workers = count;
+
+    // Workers walk their shard in disk order, the merged output is in path order
+    sort_by_disk_location(list);
+    int *by_path = malloc(count * sizeof(int));
+    int *rank = malloc(count * sizeof(int));
+    int *shard_of = malloc(count * sizeof(int));
+    int *order = malloc(count * sizeof(int));
+    char **lines = calloc(count, sizeof(char *));
+    unsigned char *state = calloc(count, 1);
+    Shard *shards = calloc(workers, sizeof(Shard));
+    long long *load = calloc(workers, sizeof(long long));
+    for (int s = 0; shards != NULL && s < workers; s++)
+        shards[s].fd = -1;
+    if (by_path == NULL || rank == NULL || shard_of == NULL || order == NULL || lines == NULL || state == NULL || shards == NULL || load == NULL)
+    {
+        fprintf(stderr, "❌ Memory allocation failed.\n");
+        status = failure;
+        goto out;
+    }
+
+    for (int i = 0; i < count; i++)
+        by_path[i] = i;
+    rank_list = list;
+    qsort(by_path, count, sizeof(int), compare_rank);
+    for (int k = 0; k < count; k++)
+        rank[by_path[k]] = k;
+
+    // Directory hash keeps albums together, size-balanced gives the largest files out first to the lightest shard
+    if (by_size)
+    {
+        long long *size = malloc(count * sizeof(long long));
+        int *largest = malloc(count * sizeof(int));
+        if (size == NULL || largest == NULL)
+        {
+            free(size);
+            free(largest);
+            fprintf(stderr, "❌ Memory allocation failed.\n");
+            status = failure;
+            goto out;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            struct stat st;
+            size[i] = (stat(list->entries[i].path, &st) == 0) ? st.st_size : 0;
+            largest[i] = i;
+        }
+        rank_size = size;
+        qsort(largest, count, sizeof(int), compare_size);
+        for (int k = 0; k < count; k++)
+        {
+            int lightest = 0;
+            for (int s = 1; s < workers; s++)
+            {
+                if (load[s] < load[lightest])
+                    lightest = s;
+            }
+            shard_of[largest[k]] = lightest;
+            load[lightest] += size[largest[k]] + 1;
+        }
+        free(size);
+        free(largest);
+    }
+    else
+    {
+        for (int i = 0; i < count; i++)
+            shard_of[i] = hash_dir(list->entries[i].path) % workers;
+    }
+
+    // Shards take the path-order windows one after the other, each window in disk order. The merge only
+    // reads from shards within one window of the output, so at most two windows of records wait in memory.
+    for (int i = 0; i < count; i++)
+        shards[shard_of[i]].count++;
+    for (int s = 0, used = 0; s < workers; s++)
+    {
+        shards[s].order = order + used;
+        used += shards[s].count;
+        shards[s].count = 0;
+    }
+    for (int k = 0; k < count; k += SHARD_WINDOW)
+    {
+        int len = (count - k < SHARD_WINDOW) ? count - k : SHARD_WINDOW;
+        qsort(&by_path[k], len, sizeof(int), compare_index);
+        for (int j = k; j < k + len; j++)
+        {
+            Shard *shard = &shards[shard_of[by_path[j]]];
+            shard->order[shard->count++] = by_path[j];
+        }
+    }
+    // by_path was sorted back into disk order within each window, restore path order
+    for (int i = 0; i < count; i++)
+        by_path[rank[i]] = i;
+
+    fprintf(stderr, "🧩 %d file(s) in %d %s shard(s)\n", count, workers, by_size ? "size-balanced" : "directory");
+    for (int s = 0; s < workers; s++)
+    {
+        if (shards[s].count > 0 && start_worker(list, shards, workers, s) != success)
+            status = failure;
+    }
+
+    int next = 0;
+    struct pollfd pfds[SHARD_MAX_WORKERS];
+    int slot[SHARD_MAX_WORKERS];
+    for (;;)
+    {
+        int active = 0, running = 0;
+        for (int s = 0; s < workers; s++)
+        {
+            if (shards[s].fd < 0)
+                continue;
+            running++;
+
+            // A shard more than a window ahead of the output waits, blocked on its pipe. The shard holding
+            // the next record is never ahead, so the merge always moves.
+            Shard *shard = &shards[s];
+            if (shard->pos < shard->count && rank[shard->order[shard->pos]] / SHARD_WINDOW > next / SHARD_WINDOW + 1)
+                continue;
+
+            pfds[active].fd = shard->fd;
+            pfds[active].events = POLLIN;
+            slot[active++] = s;
+        }
+        if (running == 0)
+            break;
+
+        if (poll(pfds, active, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("❌ poll failed");
+            status = failure;
+            break;
+        }
+
+        for (int a = 0; a < active; a++)
+        {
+            if (pfds[a].revents == 0)
+                continue;
+            Shard *shard = &shards[slot[a]];
+
+            if (shard->cap - shard->have < 8192)
+            {
+                size_t cap = shard->cap ? shard->cap * 2 : 65536;
+                unsigned char *buffer = realloc(shard->buffer, cap);
+                if (buffer == NULL)
+                {
+                    fprintf(stderr, "❌ Memory allocation failed.\n");
+                    status = failure;
+                    goto out;
+                }
+                shard->buffer = buffer;
+                shard->cap = cap;
+            }
+
+            ssize_t n = read(shard->fd, shard->buffer + shard->have, shard->cap - shard->have);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n > 0)
+            {
+                shard->have += n;
+                take_messages(shard, rank, lines, state);
+            }
+            else if (reap_worker(list, shards, workers, slot[a], rank, state, &restarts) != success)
+                status = failure;
+        }
+
+        // Everything before the first file still in flight can go out
+        for (; next < count && state[next] != 0; next++)
+        {
+            const char *path = list->entries[by_path[next]].path;
+            if (state[next] == 1)
+            {
+                fputs(lines[next], stdout);
+                free(lines[next]);
+                lines[next] = NULL;
+                batch_mark_done(journal, path);
+            }
+            else
+            {
+                failed++;
+                batch_mark_failed(journal);
+            }
+        }
+        fflush(stdout);
+    }
+
+    if (next < count)
+        status = failure;
+    fprintf(stderr, "🧩 Merged %d record(s), %d worker restart(s), %d file(s) failed\n", next - failed, restarts, failed);
+    if (failed > 0)
+        status = failure;
+
+out:
+    // Only reached early on errors with workers still running
+    for (int s = 0; shards != NULL && s < workers; s++)
+    {
+        if (shards[s].pid > 0)
+        {
+            kill(shards[s].pid, SIGKILL);
+            waitpid(shards[s].pid, NULL, 0);
+        }
+        if (shards[s].fd >= 0)
+            close(shards[s].fd);
+        free(shards[s].buffer);
+    }
+    for (int k = 0; lines != NULL && k < count; k++)
+        free(lines[k]);
+    free(by_path);
+    free(rank);
+    free(shard_of);
+    free(order);
+    free(lines);
+    free(state);
+    free(shards);
+    free(load);
+    return status;
+}
@@ -0,0 +1,238 @@
+/*
+Documentation
+Name        : Vamsi T
+Date        : 30/7/25
+Description : MP3 Tag Reader project - forward-only tag reader for pipes and stdin
+*/
+
+#define _GNU_SOURCE
+#include "mp3_tag_reader.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define STREAM_BUFFER_SIZE 4096
+
+// Reads exactly len bytes unless the input ends first, returns the bytes read or -1
+static long read_full(int fd, unsigned char *buffer, long len)
+{
+    long done = 0;
+    while (done < len)
+    {
+        ssize_t n = read(fd, buffer + done, len - done);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (n == 0)
+            break;
+        done += n;
+    }
+    return done;
+}
+
+static Status write_full(int fd, const unsigned char *buffer, long len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(fd, buffer, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return failure;
+        }
+        buffer += n;
+        len -= n;
+    }
+    return success;
+}
+
+// Skips len bytes of a non-seekable input through the bounded buffer
+static Status skip_bytes(int fd, long len, unsigned char *buffer)
+{
+    while (len > 0)
+    {
+        long want = len > STREAM_BUFFER_SIZE ? STREAM_BUFFER_SIZE : len;
+        if (read_full(fd, buffer, want) != want)
+            return failure;
+        len -= want;
+    }
+    return success;
+}
+
+Status stream_read_tags(int fd, TagRecord *record, unsigned char *consumed, long *consumed_len)
+{
+    unsigned char buffer[STREAM_BUFFER_SIZE];
+    memset(record, 0, sizeof(*record));
+    *consumed_len = 0;
+
+    long n = read_full(fd, consumed, 10);
+    if (n < 0)
+        return failure;
+    if (n < 10 || strncmp((char *)consumed, "ID3", 3) != 0)
+    {
+        *consumed_len = n; // No tag, these bytes are audio
+        return success;
+    }
+
+    record->version = consumed[3];
+    long left = convert_big_endian_to_little_endian(&consumed[6]);
+
+    // Extended header (v2.3 size excludes itself, v2.4 size includes itself)
+    if (consumed[5] & 0x40)
+    {
+        if (left < 4 || read_full(fd, buffer, 4) != 4)
+            return failure;
+        long ext = (record->version >= 4) ? (long)convert_big_endian_to_little_endian(buffer) - 4
+                                          : (long)decode_frame_size(buffer, 3);
+        if (ext < 0 || ext > left - 4 || skip_bytes(fd, ext, buffer) != success)
+            return failure;
+        left -= 4 + ext;
+    }
+
+    // v2.2 frames: 3-byte ID and 3-byte size, v2.3/v2.4: 4-byte ID, 4-byte size, 2 flag bytes
+    int id_len = (record->version == 2) ? 3 : 4;
+    int header_len = (record->version == 2) ? 6 : 10;
+
+    while (left >= header_len)
+    {
+        unsigned char header[10];
+        if (read_full(fd, header, header_len) != header_len)
+            return failure;
+        left -= header_len;
+
+        // Padding check
+        if (header[0] < 'A' || header[0] > 'Z')
+            break;
+
+        long size = (id_len == 3) ? (header[3] << 16 | header[4] << 8 | header[5])
+                                  : (long)decode_frame_size(&header[4], record->version);
+        if (size > left)
+            return failure;
+        left -= size;
+
+        // Constant-time classification, only record fields are read, the rest is drained
+        const FrameInfo *info = lookup_frame(header, id_len);
+        int field = (info != NULL) ? info->field : FIELD_NONE;
+        long keep = (field != FIELD_NONE) ? (size > STREAM_BUFFER_SIZE ? STREAM_BUFFER_SIZE : size) : 0;
+        if (keep > 0)
+        {
+            if (read_full(fd, buffer, keep) != keep)
+                return failure;
+            if (record->value[field][0] == '\0')
+                frame_decoder(info)(info, buffer, keep, record->value[field], RECORD_VALUE_LEN);
+        }
+        if (skip_bytes(fd, size - keep, buffer) != success)
+            return failure;
+    }
+
+    // Rest of the padding, then the v2.4 footer so it is not taken for audio
+    if (skip_bytes(fd, left, buffer) != success)
+        return failure;
+    if (record->version >= 4 && (consumed[5] & 0x10))
+        return skip_bytes(fd, 10, buffer);
+    return success;
+}
+
+int format_record(char *out, size_t out_len, const char *path, const TagRecord *record)
+{
+    int len = snprintf(out, out_len, "%s", path);
+    for (int i = 0; i < RECORD_FIELDS && len >= 0 && (size_t)len < out_len; i++)
+        len += snprintf(out + len, out_len - len, "\t%s", record->value[i]);
+    if (len >= 0 && (size_t)len < out_len)
+        len += snprintf(out + len, out_len - len, "\n");
+    return len;
+}
+
+void print_record(FILE *out, const char *path, const TagRecord *record)
+{
+    fprintf(out, "%s", path);
+    for (int i = 0; i < RECORD_FIELDS; i++)
+        fprintf(out, "\t%s", record->value[i]);
+    fprintf(out, "\n");
+    fflush(out);
+}
+
+static Status pass_through(int in_fd, int out_fd, off_t *total)
+{
+    unsigned char buffer[STREAM_BUFFER_SIZE];
+    int spliced = 0;
+
+    // With a pipe on either side the pages move without passing through user space
+    while (out_fd >= 0)
+    {
+        ssize_t n = splice(in_fd, NULL, out_fd, NULL, 1 << 20, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (n == 0)
+            return success;
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EINVAL && !spliced)
+                break; // Not a pipe on either side
+            return failure;
+        }
+        spliced = 1;
+        *total += n;
+    }
+
+    for (;;)
+    {
+        long n = read_full(in_fd, buffer, sizeof(buffer));
+        if (n < 0)
+            return failure;
+        if (n == 0)
+            return success;
+        if (out_fd >= 0 && write_full(out_fd, buffer, n) != success)
+            return failure;
+        *total += n;
+    }
+}
+
+Status stream(int argc, char *argv[])
+{
+    int pass = 0;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--pass") == 0)
+            pass = 1;
+        else
+        {
+            fprintf(stderr, "❌ Error: Unknown stream option '%s'\n", argv[i]);
+            return failure;
+        }
+    }
+
+    // In pass mode stdout carries the audio, so the record goes to stderr
+    FILE *out = pass ? stderr : stdout;
+
+    TagRecord record;
+    unsigned char consumed[10];
+    long consumed_len;
+    if (stream_read_tags(STDIN_FILENO, &record, consumed, &consumed_len) != success)
+    {
+        fprintf(stderr, "❌ Error: Truncated or malformed ID3v2 tag on input\n");
+        return failure;
+    }
+    print_record(out, "-", &record);
+
+    off_t audio = consumed_len;
+    if (pass && write_full(STDOUT_FILENO, consumed, consumed_len) != success)
+    {
+        perror("❌ Error writing audio");
+        return failure;
+    }
+
+    if (pass_through(STDIN_FILENO, pass ? STDOUT_FILENO : -1, &audio) != success)
+    {
+        perror("❌ Error passing audio through");
+        return failure;
+    }
+
+    fprintf(stderr, "✅ %lld bytes of audio %s\n", (long long)audio, pass ? "passed through" : "drained");
+    return success;
+}
@@ -26,6 +26,42 @@ OperationType check_operation_type(char *argv[])
     else if (strcmp(argv[1], "--help") == 0)
         return OP_HELP;
 
+    // Streaming reader
+    else if (strcmp(argv[1], "--stream") == 0)
+        return OP_STREAM;
+
+    // Library scan
+    else if (strcmp(argv[1], "--scan") == 0)
+        return OP_SCAN;
+
+    // Watch mode
+    else if (strcmp(argv[1], "--watch") == 0)
+        return OP_WATCH;
+
+    // Columnar export
+    else if (strcmp(argv[1], "--export") == 0)
+        return OP_EXPORT;
+
+    // Bulk normalize
+    else if (strcmp(argv[1], "--normalize") == 0)
+        return OP_NORMALIZE;
+
+    // Parser fuzzing
+    else if (strcmp(argv[1], "--fuzz") == 0)
+        return OP_FUZZ;
+    else if (strcmp(argv[1], "--fuzz-one") == 0)
+        return OP_FUZZ_ONE;
+
+    // Self-test on a sparse fixture past 4 GiB
+    else if (strcmp(argv[1], "--large-file-check") == 0)
+        return OP_LARGE_FILE_CHECK;
+
+    // Cover art operations
+    else if (strcmp(argv[1], "--extract-art") == 0)
+        return OP_EXTRACT_ART;
+    else if (strcmp(argv[1], "--replace-art") == 0)
+        return OP_REPLACE_ART;
+
     // Invalid or unsupported argument
     return OP_INVALID;
 }
@@ -41,10 +77,7 @@ Status read_and_validate_view_args(char *argv[], TagOperationInfo *tagopinfo)
     }
 
     // Validate .mp3 extension (basic check)
-    const char *filename = argv[2]; // sample.mp3
-    int len = strlen(filename);     // 10b
-
-    if (len < 5 || strcmp(&filename[len - 4], ".mp3") != 0)
+    if (!is_mp3_filename(argv[2]))
     {
         fprintf(stderr, "❌ Error: Invalid file format. Please provide a valid .mp3 file\n");
         return failure;
@@ -59,6 +92,13 @@ Status read_and_validate_view_args(char *argv[], TagOperationInfo *tagopinfo)
     return success;
 }
 
+int is_mp3_filename(const char *filename)
+{
+    int len = strlen(filename); // sample.mp3 -> 10
+
+    return len >= 5 && strcmp(&filename[len - 4], ".mp3") == 0;
+}
+
 Status view(TagOperationInfo *tagopinfo)
 {
     printf("╔═══════════════════════════════════════════════════════════════════════════════════╗\n");
@@ -92,18 +132,23 @@ Status view(TagOperationInfo *tagopinfo)
 
 Status check_id_and_version(TagOperationInfo *tagopinfo)
 {
-    char header[5];
+    unsigned char header[10];
     rewind(tagopinfo->fptr_mp3); // Go to start of the file
 
-    if (fread(header, sizeof(char), 5, tagopinfo->fptr_mp3) != 5)
+    if (fread(header, sizeof(char), 10, tagopinfo->fptr_mp3) != 10)
     {
         fprintf(stderr, "❌ Error: Could not read ID3 header.\n");
         return failure;
     }
 
-    if (strncmp(header, "ID3", 3) == 0)
+    if (strncmp((char *)header, "ID3", 3) == 0)
     {
         printf("🟢 ID3v2 tag found. Version: %d.%d\n", header[3], header[4]);
+
+        // Keep the header details for the edit path
+        tagopinfo->version = header[3];
+        tagopinfo->flags = header[5];
+        tagopinfo->tag_size = convert_big_endian_to_little_endian(&header[6]);
         return success;
     }
 
@@ -116,51 +161,60 @@ Status view_mp3_tags(TagOperationInfo *tagopinfo)
     printf("🎼 Viewing MP3 Tags...\n\n");
 
     rewind(tagopinfo->fptr_mp3);              // Start of file
-    fseek(tagopinfo->fptr_mp3, 10, SEEK_SET); // Skip ID3 header
+    fseeko(tagopinfo->fptr_mp3, 10, SEEK_SET); // Skip ID3 header
 
     printf("═══════════════════════════════════════════════════════════════════════════════════\n");
 
-    for (int i = 0; i < 6; i++)
+    // ID3v2.2 frames have a 3-character ID and a 3-byte size, no flags
+    off_t tag_end = 10 + (off_t)tagopinfo->tag_size;
+    int id_len = (tagopinfo->version == 2) ? 3 : 4;
+    int header_len = (tagopinfo->version == 2) ? 6 : 10;
+    while (ftello(tagopinfo->fptr_mp3) + header_len <= tag_end)
     {
         char tag[5] = {0};
-        if (fread(tag, 4, 1, tagopinfo->fptr_mp3) != 1) // TIT2
+        if (fread(tag, id_len, 1, tagopinfo->fptr_mp3) != 1) // TIT2
         {
             fprintf(stderr, "❌ Error reading tag identifier.\n");
             return failure;
         }
-        tag[4] = '\0';
 
         // Padding check
         if (tag[0] < 'A' || tag[0] > 'Z')
             break;
 
         unsigned char size_bytes[4];
-        if (fread(size_bytes, 4, 1, tagopinfo->fptr_mp3) != 1)
+        if (fread(size_bytes, id_len, 1, tagopinfo->fptr_mp3) != 1)
         {
             fprintf(stderr, "❌ Error reading size for tag: %s\n", tag);
             return failure;
         }
-        unsigned int size = convert_big_endian_to_little_endian(size_bytes);
+        unsigned int size = (id_len == 3) ? (unsigned int)(size_bytes[0] << 16 | size_bytes[1] << 8 | size_bytes[2])
+                                          : decode_frame_size(size_bytes, tagopinfo->version);
 
-        fseek(tagopinfo->fptr_mp3, 3, SEEK_CUR); // Skip flags
+        if (id_len == 4)
+            fseeko(tagopinfo->fptr_mp3, 2, SEEK_CUR); // Skip flags
 
-        char *cont = (char *)malloc(size + 1); // char buffer[size];
-        if (cont == NULL)
+        // Size must stay inside the tag
+        off_t content_offset = ftello(tagopinfo->fptr_mp3);
+        if (check_frame_fits(content_offset, size, tag_end) != success)
         {
-            fprintf(stderr, "❌ Memory allocation failed.\n");
+            fprintf(stderr, "❌ Invalid size %u for tag: %s\n", size, tag);
             return failure;
         }
 
-        if (fread(cont, size - 1, 1, tagopinfo->fptr_mp3) != 1)
+        // Only the start of large frames (pictures, objects) is needed for display
+        unsigned char cont[VIEW_FRAME_LIMIT];
+        unsigned int available = size < VIEW_FRAME_LIMIT ? size : VIEW_FRAME_LIMIT;
+        if (available > 0 && fread(cont, available, 1, tagopinfo->fptr_mp3) != 1)
         {
             fprintf(stderr, "❌ Error reading content for tag: %s\n", tag);
-            free(cont);
             return failure;
         }
-        cont[size] = '\0';                      // Null-terminate
-        compare_view_tags(tag, size - 1, cont); // Call your tag print handler
+        compare_view_tags(tag, size, cont); // Call your tag print handler
 
-        free(cont);
+        // Seeking drops the stdio buffer, only do it when part of the frame was left unread
+        if (available < size)
+            fseeko(tagopinfo->fptr_mp3, content_offset + size, SEEK_SET);
     }
 
     printf("═══════════════════════════════════════════════════════════════════════════════════\n");
@@ -168,22 +222,67 @@ Status view_mp3_tags(TagOperationInfo *tagopinfo)
     return success;
 }
 
-void compare_view_tags(char tag[], int size, char cont[])
+Status find_frame(TagOperationInfo *tagopinfo, const char *id, off_t *frame_offset, unsigned int *size)
 {
-    const char *display_labels[6] = {"🎼 Title     ", "🎤 Artist    ", "💿 Album     ", "📅 Year      ", "🎼 Genre     ", "💬 Comment   "};
-    const char *tag_ids[6] = {"TIT2", "TPE1", "TALB", "TYER", "TCON", "COMM"};
+    off_t tag_end = 10 + (off_t)tagopinfo->tag_size;
 
-    for (int i = 0; i < 6; i++)
+    // 10-byte frame headers only, callers refuse ID3v2.2
+    if (tagopinfo->version < 3)
+        return failure;
+
+    // Walk the frame headers only, frame contents are skipped with fseek
+    fseeko(tagopinfo->fptr_mp3, 10, SEEK_SET);
+    while (ftello(tagopinfo->fptr_mp3) + 10 <= tag_end)
     {
-        if (strcmp(tag, tag_ids[i]) == 0)
-        {
+        unsigned char header[10];
+        if (fread(header, 10, 1, tagopinfo->fptr_mp3) != 1)
+            return failure;
 
-            printf(" %s: ", display_labels[i]);
-            print(cont, size); // Calls print function for clean output
-            printf("\n");
-            break;
+        // Padding check
+        if (header[0] < 'A' || header[0] > 'Z')
+            return failure;
+
+        unsigned int frame_size = decode_frame_size(&header[4], tagopinfo->version);
+        if (check_frame_fits(ftello(tagopinfo->fptr_mp3), frame_size, tag_end) != success)
+            return failure;
+
+        if (strncmp((char *)header, id, 4) == 0)
+        {
+            *frame_offset = ftello(tagopinfo->fptr_mp3) - 10;
+            *size = frame_size;
+            return success;
         }
+
+        if (frame_size > 0)
+            fseeko(tagopinfo->fptr_mp3, frame_size, SEEK_CUR);
+    }
+
+    return failure;
+}
+
+void compare_view_tags(char tag[], unsigned int size, unsigned char cont[])
+{
+    const char *display_labels[RECORD_FIELDS] = {"🎼 Title     ", "🎤 Artist    ", "💿 Album     ", "📅 Year      ", "🎼 Genre     ", "💬 Comment   "};
+
+    const FrameInfo *info = lookup_frame((unsigned char *)tag, strlen(tag));
+    if (info == NULL)
+    {
+        printf(" ❔ %s (unknown frame): %u bytes\n", tag, size);
+        return;
     }
+
+    char value[RECORD_VALUE_LEN];
+    frame_decoder(info)(info, cont, size < VIEW_FRAME_LIMIT ? size : VIEW_FRAME_LIMIT, value, sizeof(value));
+
+    if (info->field != FIELD_NONE)
+        printf(" %s: ", display_labels[info->field]);
+    else
+        printf(" 🏷️  %s (%s): ", tag, info->description);
+
+    print(value, strlen(value)); // Calls print function for clean output
+    if (info->type == FRAME_PICTURE || info->type == FRAME_BINARY)
+        printf("%s%u bytes", value[0] ? ", " : "", size);
+    printf("\n");
 }
 
 unsigned int convert_big_endian_to_little_endian(unsigned char *bytes)
@@ -197,6 +296,24 @@ unsigned int convert_big_endian_to_little_endian(unsigned char *bytes)
     // Synchsafe integers avoid this by ensuring no byte ever has its high bit set.
 }
 
+Status check_frame_fits(off_t offset, unsigned int size, off_t end)
+{
+    // Compare against the space left so a huge size can never wrap around
+    if (offset < 0 || offset > end || (off_t)size > end - offset)
+        return failure;
+
+    return success;
+}
+
+unsigned int decode_frame_size(unsigned char *bytes, unsigned char version)
+{
+    // ID3v2.4 frame sizes are synchsafe, ID3v2.3 frame sizes are plain 32-bit big endian
+    if (version >= 4)
+        return convert_big_endian_to_little_endian(bytes);
+
+    return ((unsigned int)bytes[0] << 24) | ((unsigned int)bytes[1] << 16) | ((unsigned int)bytes[2] << 8) | bytes[3];
+}
+
 void print(const char *cont, int size)
 {
     int start = 0;
@@ -0,0 +1,689 @@
+/*
+Documentation
+Name        : Vamsi T
+Date        : 30/7/25
+Description : MP3 Tag Reader project - watch mode, incremental re-index with inotify
+*/
+
+#define _GNU_SOURCE
+#include "mp3_tag_reader.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WATCH_SETTLE_MS 500 // Quiet time before a file that is being written is parsed
+#define WATCH_COMPACT_MIN 1024 // Changes logged before the index snapshot is rewritten
+#define WATCH_EVENTS \
+    (IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF)
+
+// One file of the in-memory index
+typedef struct
+{
+    char *path;
+    char *line;                  // Record line, NULL when the file is gone
+    long long size;              // Size and mtime when the line was parsed, a restart re-parses only on a change
+    long long mtime_ns;
+    unsigned long long tag_hash; // Hash of the raw tag bytes, to skip unchanged tags (0 after loading the index)
+    long long first_event;       // Oldest event not yet indexed (ms), 0 if none
+    long long last_event;        // Newest event (ms), the file settles WATCH_SETTLE_MS after it
+    int deleted;
+} WatchEntry;
+
+typedef struct
+{
+    int fd;
+    char **dirs; // Watch descriptor -> directory
+    int dir_count;
+
+    WatchEntry *entries; // Open-addressing table keyed by path
+    int capacity;
+    int count;
+    int pending;
+
+    const char *index_path;
+    FILE *log;     // <index>.log, U/D changes since the snapshot was written
+    int log_lines;
+    long long lag_total;
+    long long lag_max;
+    int lag_count;
+    int indexed;
+} Watcher;
+
+static volatile sig_atomic_t watch_stop = 0;
+
+static void stop_watching(int sig)
+{
+    (void)sig;
+    watch_stop = 1;
+}
+
+static long long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+static unsigned int hash_string(const char *s)
+{
+    unsigned int h = 2166136261u;
+    while (*s)
+    {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static WatchEntry *watch_entry(Watcher *w, const char *path, int create)
+{
+    if (w->capacity > 0)
+    {
+        unsigned int slot = hash_string(path) & (w->capacity - 1);
+        while (w->entries[slot].path != NULL)
+        {
+            if (strcmp(w->entries[slot].path, path) == 0)
+                return &w->entries[slot];
+            slot = (slot + 1) & (w->capacity - 1);
+        }
+    }
+
+    if (!create)
+        return NULL;
+
+    // Grow at half full, entries are never removed (deleted files keep their slot)
+    if ((w->count + 1) * 2 > w->capacity)
+    {
+        int capacity = w->capacity ? w->capacity * 2 : 1024;
+        WatchEntry *entries = calloc(capacity, sizeof(WatchEntry));
+        if (entries == NULL)
+            return NULL;
+        for (int i = 0; i < w->capacity; i++)
+        {
+            if (w->entries[i].path == NULL)
+                continue;
+            unsigned int slot = hash_string(w->entries[i].path) & (capacity - 1);
+            while (entries[slot].path != NULL)
+                slot = (slot + 1) & (capacity - 1);
+            entries[slot] = w->entries[i];
+        }
+        free(w->entries);
+        w->entries = entries;
+        w->capacity = capacity;
+    }
+
+    unsigned int slot = hash_string(path) & (w->capacity - 1);
+    while (w->entries[slot].path != NULL)
+        slot = (slot + 1) & (w->capacity - 1);
+
+    WatchEntry *entry = &w->entries[slot];
+    entry->path = strdup(path);
+    if (entry->path == NULL)
+        return NULL;
+    w->count++;
+    return entry;
+}
+
+// FNV-1a over the ID3v2 header and tag, audio bytes are not read
+static unsigned long long tag_region_hash(const char *path)
+{
+    unsigned long long h = 14695981039346656037ULL;
+    unsigned char buffer[64 * 1024];
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    off_t end = 10;
+    for (off_t pos = 0; pos < end;)
+    {
+        size_t want = (end - pos) > (off_t)sizeof(buffer) ? sizeof(buffer) : (size_t)(end - pos);
+        ssize_t n = pread(fd, buffer, want, pos);
+        if (n <= 0)
+            break;
+
+        if (pos == 0 && n >= 10 && strncmp((char *)buffer, "ID3", 3) == 0)
+            end = 10 + (off_t)convert_big_endian_to_little_endian(&buffer[6]);
+
+        for (ssize_t i = 0; i < n; i++)
+        {
+            h ^= buffer[i];
+            h *= 1099511628211ULL;
+        }
+        pos += n;
+    }
+
+    close(fd);
+    return h;
+}
+
+static long long stat_mtime_ns(const struct stat *st)
+{
+    return st->st_mtim.tv_sec * 1000000000LL + st->st_mtim.tv_nsec;
+}
+
+static void mark_pending(Watcher *w, const char *path, long long now)
+{
+    WatchEntry *entry = watch_entry(w, path, 1);
+    if (entry == NULL)
+        return;
+
+    if (entry->first_event == 0)
+    {
+        entry->first_event = now;
+        w->pending++;
+    }
+    entry->last_event = now;
+}
+
+static void add_watch_tree(Watcher *w, const char *dir)
+{
+    int wd = inotify_add_watch(w->fd, dir, WATCH_EVENTS | IN_ONLYDIR);
+    if (wd < 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to watch '%s': %s\n", dir, strerror(errno));
+        return;
+    }
+
+    if (wd >= w->dir_count)
+    {
+        int count = wd + 64;
+        char **dirs = realloc(w->dirs, count * sizeof(char *));
+        if (dirs == NULL)
+            return;
+        memset(dirs + w->dir_count, 0, (count - w->dir_count) * sizeof(char *));
+        w->dirs = dirs;
+        w->dir_count = count;
+    }
+    free(w->dirs[wd]);
+    w->dirs[wd] = strdup(dir);
+
+    // Files that appeared before the watch existed are picked up by the caller's scan
+    DIR *d = opendir(dir);
+    if (d == NULL)
+        return;
+
+    struct dirent *de;
+    char child[4096];
+    while ((de = readdir(d)) != NULL)
+    {
+        if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0)
+            continue;
+        if (snprintf(child, sizeof(child), "%s/%s", dir, de->d_name) >= (int)sizeof(child))
+            continue;
+
+        struct stat st;
+        if (lstat(child, &st) != 0)
+            continue;
+        if (S_ISDIR(st.st_mode))
+        {
+            add_watch_tree(w, child);
+            continue;
+        }
+
+        if (!S_ISREG(st.st_mode) || !is_mp3_filename(child))
+            continue;
+
+        // New files, and files the loaded index has with another size or mtime
+        WatchEntry *entry = watch_entry(w, child, 0);
+        if (entry == NULL || entry->line == NULL || entry->size != st.st_size || entry->mtime_ns != stat_mtime_ns(&st))
+            mark_pending(w, child, now_ms());
+    }
+    closedir(d);
+}
+
+/*
+ * The index is a snapshot, <index>, plus a change log, <index>.log. Snapshot lines are
+ * "<size>\t<mtime_ns>\t<record>", log lines are "U\t<size>\t<mtime_ns>\t<record>" or "D\t<path>"; stdout
+ * carries the same U/D changes without the size and mtime. A flush only appends to the log. The snapshot
+ * is rewritten once the log holds a quarter as many lines as the index has files, so a change costs O(1)
+ * amortised instead of a full rewrite. Readers load the snapshot and replay the log; replaying a change
+ * twice is harmless, so a crash between the snapshot rename and the log truncate loses nothing.
+ */
+
+// "<size>\t<mtime_ns>\t<record>\n" from the snapshot or a U line of the log
+static void load_index_record(Watcher *w, const char *text)
+{
+    char *end;
+    long long size = strtoll(text, &end, 10);
+    if (*end != '\t')
+        return;
+    long long mtime_ns = strtoll(end + 1, &end, 10);
+    if (*end != '\t')
+        return;
+
+    const char *record = end + 1;
+    const char *tab = strchr(record, '\t');
+    size_t len = strlen(record);
+    if (tab == NULL || len == 0 || record[len - 1] != '\n')
+        return; // Torn line, the file is parsed again
+
+    char path[4200];
+    if ((size_t)(tab - record) >= sizeof(path))
+        return;
+    memcpy(path, record, tab - record);
+    path[tab - record] = '\0';
+
+    WatchEntry *entry = watch_entry(w, path, 1);
+    char *line = strdup(record);
+    if (entry == NULL || line == NULL)
+    {
+        free(line);
+        return;
+    }
+    free(entry->line);
+    entry->line = line;
+    entry->size = size;
+    entry->mtime_ns = mtime_ns;
+    entry->deleted = 0;
+}
+
+// Loads the snapshot and replays the log onto it, then keeps the log open for appending
+static Status open_index_log(Watcher *w)
+{
+    if (w->index_path == NULL)
+        return success;
+
+    char *text = NULL;
+    size_t cap = 0;
+    ssize_t len = 0;
+    int loaded = 0;
+
+    FILE *fp = fopen(w->index_path, "r");
+    if (fp != NULL)
+    {
+        while ((len = getline(&text, &cap, fp)) > 0)
+        {
+            load_index_record(w, text);
+            loaded++;
+        }
+        fclose(fp);
+    }
+
+    char path[4200];
+    snprintf(path, sizeof(path), "%s.log", w->index_path);
+    w->log = fopen(path, "a+");
+    if (w->log == NULL)
+    {
+        fprintf(stderr, "❌ Error: Unable to open index log '%s': %s\n", path, strerror(errno));
+        free(text);
+        return failure;
+    }
+
+    len = 0;
+    int torn = 0;
+    while ((len = getline(&text, &cap, w->log)) > 0)
+    {
+        torn = (text[len - 1] != '\n');
+        if (strncmp(text, "U\t", 2) == 0)
+            load_index_record(w, text + 2);
+        else if (strncmp(text, "D\t", 2) == 0 && !torn)
+        {
+            text[len - 1] = '\0';
+            WatchEntry *entry = watch_entry(w, text + 2, 0);
+            if (entry != NULL)
+            {
+                free(entry->line);
+                entry->line = NULL;
+                entry->deleted = 1;
+            }
+        }
+        w->log_lines++;
+    }
+    free(text);
+
+    // A crash mid-append left a partial line, end it so the next change starts on its own line
+    if (torn && fputc('\n', w->log) == EOF)
+        return failure;
+
+    if (loaded > 0 || w->log_lines > 0)
+        fprintf(stderr, "📖 Loaded %d file(s) from the index and %d change(s) from its log\n", loaded, w->log_lines);
+    return success;
+}
+
+static Status write_index(Watcher *w)
+{
+    if (w->index_path == NULL)
+        return success;
+
+    // Rewrite next to the index and rename, readers never see a half-written file
+    char tmp[4200];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", w->index_path);
+    FILE *fp = fopen(tmp, "w");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "❌ Error: Unable to write index '%s': %s\n", tmp, strerror(errno));
+        return failure;
+    }
+
+    for (int i = 0; i < w->capacity; i++)
+    {
+        if (w->entries[i].path != NULL && w->entries[i].line != NULL)
+            fprintf(fp, "%lld\t%lld\t%s", w->entries[i].size, w->entries[i].mtime_ns, w->entries[i].line);
+    }
+
+    if (fflush(fp) != 0 || fsync(fileno(fp)) != 0 || fclose(fp) != 0 || rename(tmp, w->index_path) != 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to update index '%s'\n", w->index_path);
+        return failure;
+    }
+
+    // Everything in the log is in the snapshot now
+    if (fflush(w->log) != 0 || ftruncate(fileno(w->log), 0) != 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to truncate index log of '%s'\n", w->index_path);
+        return failure;
+    }
+    w->log_lines = 0;
+    return success;
+}
+
+// Makes the changes of one flush durable, compacting when the log has grown
+static Status sync_index(Watcher *w)
+{
+    if (w->log == NULL)
+        return success;
+
+    if (w->log_lines >= WATCH_COMPACT_MIN && w->log_lines * 4 >= w->count)
+        return write_index(w);
+
+    if (fflush(w->log) != 0 || fdatasync(fileno(w->log)) != 0)
+    {
+        fprintf(stderr, "❌ Error: Unable to append to index log of '%s'\n", w->index_path);
+        return failure;
+    }
+    return success;
+}
+
+// One U line (entry has a record) or D line (entry is gone) on stdout and in the index log
+static void emit_change(Watcher *w, const WatchEntry *entry)
+{
+    if (entry->line != NULL)
+        printf("U\t%s", entry->line);
+    else
+        printf("D\t%s\n", entry->path);
+    fflush(stdout);
+
+    if (w->log != NULL)
+    {
+        if (entry->line != NULL)
+            fprintf(w->log, "U\t%lld\t%lld\t%s", entry->size, entry->mtime_ns, entry->line);
+        else
+            fprintf(w->log, "D\t%s\n", entry->path);
+        w->log_lines++;
+    }
+}
+
+// Parses one settled file, only when its tag bytes changed
+static void index_entry(Watcher *w, WatchEntry *entry, long long now, int report)
+{
+    long long lag = now - entry->first_event;
+    entry->first_event = 0;
+    w->pending--;
+
+    struct stat st;
+    if (stat(entry->path, &st) != 0)
+    {
+        if (entry->line != NULL)
+        {
+            free(entry->line);
+            entry->line = NULL;
+            emit_change(w, entry);
+        }
+        entry->deleted = 1;
+        return;
+    }
+    entry->deleted = 0;
+
+    unsigned long long hash = tag_region_hash(entry->path);
+    if (entry->line != NULL && hash == entry->tag_hash)
+    {
+        // Audio or metadata-only change, the tag is the same; the next snapshot records the new stat
+        entry->size = st.st_size;
+        entry->mtime_ns = stat_mtime_ns(&st);
+        return;
+    }
+
+    TagRecord record;
+    off_t bytes = 0;
+    ScanEntry scan_entry = {entry->path, 0, -1};
+    if (scan_file(&scan_entry, &record, &bytes, 0) != success)
+        return; // Still being written or corrupt, the next event retries
+
+    char line[RECORD_FIELDS * RECORD_VALUE_LEN + 4200];
+    format_record(line, sizeof(line), entry->path, &record);
+    free(entry->line);
+    entry->line = strdup(line);
+    entry->tag_hash = hash;
+    entry->size = st.st_size;
+    entry->mtime_ns = stat_mtime_ns(&st);
+
+    emit_change(w, entry);
+
+    w->indexed++;
+    if (report)
+    {
+        w->lag_total += lag;
+        w->lag_count++;
+        if (lag > w->lag_max)
+            w->lag_max = lag;
+        fprintf(stderr, "⚡ Indexed %s (lag %lld ms, avg %lld ms, max %lld ms)\n", entry->path, lag,
+                w->lag_total / w->lag_count, w->lag_max);
+    }
+}
+
+// Indexes every pending file that has been quiet long enough, returns ms until the next one is due or -1
+static int flush_settled(Watcher *w, int report)
+{
+    long long now = now_ms();
+    long long next = -1;
+    int changed = 0;
+
+    for (int i = 0; i < w->capacity && w->pending > 0; i++)
+    {
+        WatchEntry *entry = &w->entries[i];
+        if (entry->path == NULL || entry->first_event == 0)
+            continue;
+
+        long long due = entry->last_event + (report ? WATCH_SETTLE_MS : 0);
+        if (due <= now)
+        {
+            index_entry(w, entry, now, report);
+            changed = 1;
+        }
+        else if (next < 0 || due - now < next)
+            next = due - now;
+    }
+
+    if (changed)
+        sync_index(w);
+    return (int)next;
+}
+
+// A directory moved away or deleted: its files leave the index with a D line and its watches are dropped
+static void drop_watch_tree(Watcher *w, const char *dir)
+{
+    size_t len = strlen(dir);
+    int changed = 0;
+
+    for (int i = 0; i < w->capacity; i++)
+    {
+        WatchEntry *entry = &w->entries[i];
+        if (entry->path == NULL || strncmp(entry->path, dir, len) != 0 || entry->path[len] != '/')
+            continue;
+
+        if (entry->first_event != 0)
+        {
+            entry->first_event = 0;
+            w->pending--;
+        }
+        entry->deleted = 1;
+        if (entry->line != NULL)
+        {
+            free(entry->line);
+            entry->line = NULL;
+            emit_change(w, entry);
+            changed = 1;
+        }
+    }
+
+    for (int wd = 0; wd < w->dir_count; wd++)
+    {
+        if (w->dirs[wd] == NULL || strncmp(w->dirs[wd], dir, len) != 0 ||
+            (w->dirs[wd][len] != '\0' && w->dirs[wd][len] != '/'))
+            continue;
+        inotify_rm_watch(w->fd, wd); // Fails harmlessly when the kernel already dropped it
+        free(w->dirs[wd]);
+        w->dirs[wd] = NULL;
+    }
+
+    if (changed)
+        sync_index(w);
+}
+
+static void handle_events(Watcher *w)
+{
+    char buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    long long now = now_ms();
+
+    ssize_t len = read(w->fd, buffer, sizeof(buffer));
+    for (char *p = buffer; len > 0 && p < buffer + len;)
+    {
+        struct inotify_event *ev = (struct inotify_event *)p;
+        p += sizeof(struct inotify_event) + ev->len;
+
+        if (ev->mask & IN_Q_OVERFLOW)
+        {
+            fprintf(stderr, "⚠️  Event queue overflowed, some changes may be picked up late\n");
+            continue;
+        }
+        if (ev->wd < 0 || ev->wd >= w->dir_count || w->dirs[ev->wd] == NULL)
+            continue;
+
+        char path[4200];
+
+        // The watched directory itself went away, for a root this is the only event
+        if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+        {
+            snprintf(path, sizeof(path), "%s", w->dirs[ev->wd]);
+            drop_watch_tree(w, path);
+            continue;
+        }
+        if (ev->len == 0)
+            continue;
+
+        snprintf(path, sizeof(path), "%s/%s", w->dirs[ev->wd], ev->name);
+
+        if (ev->mask & IN_ISDIR)
+        {
+            if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+                add_watch_tree(w, path); // New album directory
+            else if (ev->mask & (IN_MOVED_FROM | IN_DELETE))
+                drop_watch_tree(w, path); // Album renamed or removed
+            continue;
+        }
+
+        // Bursts of writes to the same file collapse into one pending entry
+        if (is_mp3_filename(path))
+            mark_pending(w, path, now);
+    }
+}
+
+Status watch(int argc, char *argv[])
+{
+    Watcher w = {0};
+    int roots = 0;
+
+    w.fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (w.fd < 0)
+    {
+        perror("❌ inotify_init1 failed");
+        return failure;
+    }
+
+    for (int i = 2; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--index") == 0)
+            w.index_path = argv[++i];
+    }
+
+    // The index is loaded first, so the walk below only queues files that are new or changed since
+    if (open_index_log(&w) != success)
+    {
+        close(w.fd);
+        return failure;
+    }
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--index") == 0 && i + 1 < argc)
+        {
+            i++;
+            continue;
+        }
+        add_watch_tree(&w, argv[i]);
+        roots++;
+    }
+
+    if (roots == 0)
+    {
+        fprintf(stderr, "❌ Error: No library directory to watch\n");
+        if (w.log != NULL)
+            fclose(w.log);
+        close(w.fd);
+        return failure;
+    }
+
+    // Files in the index that went away while nothing was watching get their D line
+    struct stat st;
+    for (int i = 0; i < w.capacity; i++)
+    {
+        if (w.entries[i].path != NULL && w.entries[i].line != NULL && w.entries[i].first_event == 0 &&
+            stat(w.entries[i].path, &st) != 0)
+            mark_pending(&w, w.entries[i].path, now_ms());
+    }
+
+    // Initial index of what is new or changed, appended to the log like any other change
+    fprintf(stderr, "📚 Indexing %d file(s)...\n", w.pending);
+    flush_settled(&w, 0);
+    fprintf(stderr, "👀 Watching for changes (Ctrl+C to stop)\n");
+
+    struct sigaction sa = {0};
+    sa.sa_handler = stop_watching;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    while (!watch_stop)
+    {
+        struct pollfd pfd = {w.fd, POLLIN, 0};
+        int timeout = w.pending > 0 ? flush_settled(&w, 1) : -1;
+        if (poll(&pfd, 1, timeout) > 0)
+            handle_events(&w);
+    }
+
+    // Index whatever is still pending before exiting, and leave a compact snapshot
+    flush_settled(&w, 0);
+    write_index(&w);
+    if (w.log != NULL)
+        fclose(w.log);
+
+    for (int i = 0; i < w.capacity; i++)
+    {
+        free(w.entries[i].path);
+        free(w.entries[i].line);
+    }
+    for (int i = 0; i < w.dir_count; i++)
+        free(w.dirs[i]);
+    free(w.entries);
+    free(w.dirs);
+    close(w.fd);
+
+    fprintf(stderr, "\n✅ Watch stopped, %d file(s) indexed\n", w.indexed);
+    return success;
+}